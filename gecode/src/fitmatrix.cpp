@@ -0,0 +1,110 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main author:
+ *     Michael Brendle <michaelbrendle@me.com>
+ *
+ */
+
+#include "fitmatrix.hh"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+FitMatrix::FitMatrix(const WarehouseSnapshot& s, const vector<WarehouseGood>& goods)
+  : numGoods(goods.size()), numPlaces(s.warehousePosition.size()) {
+    for (int g = 0; g < numGoods; g++) {
+        tempMins.push_back(goods[g].tempMin);
+        tempMaxs.push_back(goods[g].tempMax);
+        lightMins.push_back(goods[g].lightMin);
+        lightMaxs.push_back(goods[g].lightMax);
+    }
+
+    int sensorAt[49];
+    for (int p = 0; p < 49; p++) {
+        sensorAt[p] = 0;
+    }
+    for (unsigned int i = 0; i < s.sections.size(); i++) {
+        if (s.sections[i].position >= 0 && s.sections[i].position < 49) {
+            sensorAt[s.sections[i].position] = s.sections[i].sensor;
+        }
+    }
+    for (int w = 0; w < numPlaces; w++) {
+        int position = s.warehousePosition[w];
+        positions.push_back(position);
+        sensors.push_back(position >= 0 && position < 49 ? sensorAt[position] : 0);
+        temps.push_back(s.warehouseTemp[w]);
+        lights.push_back(s.warehouseLight[w]);
+    }
+
+    fit.resize(numGoods * numPlaces);
+    for (int w = 0; w < numPlaces; w++) {
+        column(w);
+    }
+}
+
+void
+FitMatrix::column(int w) {
+    int temp = temps[w];
+    int light = lights[w];
+    int* out = numGoods > 0 ? &fit[w * numGoods] : NULL;
+    int g = 0;
+#ifdef __SSE2__
+    // A good does not fit, if one of its bounds is violated:
+    // tempMin > temp, temp > tempMax, lightMin > light or light > lightMax.
+    const __m128i t = _mm_set1_epi32(temp);
+    const __m128i l = _mm_set1_epi32(light);
+    const __m128i one = _mm_set1_epi32(1);
+    for (; g + 4 <= numGoods; g += 4) {
+        __m128i tMin = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&tempMins[g]));
+        __m128i tMax = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&tempMaxs[g]));
+        __m128i lMin = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&lightMins[g]));
+        __m128i lMax = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&lightMaxs[g]));
+        __m128i violated = _mm_or_si128(_mm_or_si128(_mm_cmpgt_epi32(tMin, t),
+                                                     _mm_cmpgt_epi32(t, tMax)),
+                                        _mm_or_si128(_mm_cmpgt_epi32(lMin, l),
+                                                     _mm_cmpgt_epi32(l, lMax)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + g), _mm_andnot_si128(violated, one));
+    }
+#endif
+    for (; g < numGoods; g++) {
+        out[g] = tempMins[g] <= temp && temp <= tempMaxs[g]
+          && lightMins[g] <= light && light <= lightMaxs[g];
+    }
+}
+
+bool
+FitMatrix::fits(int g, int w) const {
+    return fit[w * numGoods + g] != 0;
+}
+
+vector<int>
+FitMatrix::unfit(int g) const {
+    vector<int> places;
+    for (int w = 0; w < numPlaces; w++) {
+        if (!fit[w * numGoods + g]) {
+            places.push_back(positions[w]);
+        }
+    }
+    return places;
+}
+
+int
+FitMatrix::update(int sensor, int temperature, int lighting) {
+    int changed = 0;
+    for (int w = 0; w < numPlaces; w++) {
+        if (sensors[w] != sensor) {
+            continue;
+        }
+        vector<int> before(fit.begin() + w * numGoods, fit.begin() + (w + 1) * numGoods);
+        temps[w] = temperature;
+        lights[w] = lighting;
+        column(w);
+        for (int g = 0; g < numGoods; g++) {
+            changed += before[g] != fit[w * numGoods + g];
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,60 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main author:
+ *     Michael Brendle <michaelbrendle@me.com>
+ *
+ */
+
+#ifndef __WAREHOUSE_FITMATRIX_HH__
+#define __WAREHOUSE_FITMATRIX_HH__
+
+#include "planner.hh"
+
+#include <vector>
+
+/* -------------------------------
+ *  FIT MATRIX
+ *
+ *  Which good fits which Warehouse place, for all goods and places at
+ *  once. The ranges of the goods are stored in one array per bound, and
+ *  each column (one place, all goods) is computed four goods at a time
+ *  with SSE2, if the compiler supports it. A column is recomputed alone,
+ *  when the values of its sensor change.
+ *  -------------------------------
+ */
+
+class FitMatrix {
+protected:
+  int numGoods;
+  int numPlaces;
+  /// Ranges of the goods.
+  std::vector<int> tempMins;
+  std::vector<int> tempMaxs;
+  std::vector<int> lightMins;
+  std::vector<int> lightMaxs;
+  /// Position, sensor, temperature and light of the Warehouse places.
+  std::vector<int> positions;
+  std::vector<int> sensors;
+  std::vector<int> temps;
+  std::vector<int> lights;
+  /// fit[w * numGoods + g] is 1, if the good g fits the place w.
+  std::vector<int> fit;
+
+  /// Computes the column of the place \a w.
+  void column(int w);
+public:
+  /// Matrix of \a goods (e.g. the goods of a job) and the Warehouse places
+  /// of \a s.
+  FitMatrix(const WarehouseSnapshot& s, const std::vector<WarehouseGood>& goods);
+
+  /// Returns true, if the good \a g fits the Warehouse place \a w.
+  bool fits(int g, int w) const;
+  /// Positions of the Warehouse places that do not fit the good \a g.
+  std::vector<int> unfit(int g) const;
+
+  /// Sets the values of the sensor \a sensor (1, 2, ...) and recomputes
+  /// the columns of its places. Returns the number of changed entries.
+  int update(int sensor, int temperature, int lighting);
+};
+
+#endif
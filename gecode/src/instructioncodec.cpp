@@ -0,0 +1,202 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main author:
+ *     Michael Brendle <michaelbrendle@me.com>
+ *
+ */
+
+#include "instructioncodec.hh"
+
+#include <sstream>
+#include <vector>
+#include <cstdlib>
+
+using namespace std;
+
+/// Movements in the order of their codes.
+static const char* movements[] = { "FORWARD", "BACKWARD", "TURN", "PICK", "DROP", "SYNC" };
+static const int numMovements = 6;
+
+/// CRC-8 with the polynomial 0x07.
+static unsigned char
+crc8(const string& data, size_t begin, size_t end) {
+    unsigned char crc = 0;
+    for (size_t k = begin; k < end; k++) {
+        crc ^= (unsigned char) data[k];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = crc & 0x80 ? (unsigned char) ((crc << 1) ^ 0x07) : (unsigned char) (crc << 1);
+        }
+    }
+    return crc;
+}
+
+/// Splits \a s at \a separator. A separator at the end gives no empty
+/// last part.
+static vector<string>
+split(const string& s, char separator) {
+    vector<string> parts;
+    size_t begin = 0;
+    while (begin < s.size()) {
+        size_t end = s.find(separator, begin);
+        if (end == string::npos) {
+            end = s.size();
+        }
+        parts.push_back(s.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return parts;
+}
+
+/// Returns true, if \a s is a number from 0 to 255.
+static bool
+byteValue(const string& s, int& value) {
+    if (s.empty() || s.size() > 3 || s.find_first_not_of("0123456789") != string::npos) {
+        return false;
+    }
+    value = atoi(s.c_str());
+    return value <= 255;
+}
+
+bool
+encodeInstructions(const string& text, string& frame) {
+    string payload;
+    vector<string> instructions = split(text, ';');
+    for (unsigned int k = 0; k < instructions.size(); k++) {
+        vector<string> fields = split(instructions[k], ',');
+        if (fields.size() < 2) {
+            return false;
+        }
+        int movement = 0;
+        while (movement < numMovements && fields[0] != movements[movement]) {
+            movement++;
+        }
+        int value;
+        if (movement == numMovements || !byteValue(fields[1], value)) {
+            return false;
+        }
+        // Only a FORWARD has a sensor and only a TURN a direction.
+        int flag = 0;
+        if (fields.size() == 3 && fields[0] == "FORWARD" && (fields[2] == "0" || fields[2] == "1")) {
+            flag = fields[2] == "1";
+        } else if (fields.size() == 3 && fields[0] == "TURN" && (fields[2] == "LEFT" || fields[2] == "RIGHT")) {
+            flag = fields[2] == "RIGHT";
+        } else if (fields.size() != 2 || fields[0] == "FORWARD" || fields[0] == "TURN") {
+            return false;
+        }
+        bool inlined = value >= 1 && value <= 15;
+        payload += (char) (movement << 5 | (inlined ? value : 0) << 1 | flag);
+        if (!inlined) {
+            payload += (char) value;
+        }
+    }
+    if (payload.size() > 255) {
+        return false;
+    }
+    frame = "";
+    frame += (char) frameStart;
+    frame += (char) payload.size();
+    frame += payload;
+    frame += (char) crc8(frame, 1, frame.size());
+    return true;
+}
+
+bool
+decodeInstructions(const string& frame, string& text) {
+    if (frame.size() < 3 || (unsigned char) frame[0] != frameStart) {
+        return false;
+    }
+    size_t length = (unsigned char) frame[1];
+    if (frame.size() != length + 3 || (unsigned char) frame[length + 2] != crc8(frame, 1, length + 2)) {
+        return false;
+    }
+    stringstream out;
+    for (size_t k = 2; k < length + 2; k++) {
+        unsigned char code = frame[k];
+        int movement = code >> 5;
+        int value = (code >> 1) & 15;
+        int flag = code & 1;
+        if (movement >= numMovements) {
+            return false;
+        }
+        if (value == 0) {
+            if (++k == length + 2) {
+                return false;
+            }
+            value = (unsigned char) frame[k];
+        }
+        out << movements[movement] << "," << value;
+        if (movement == 0) {
+            out << "," << flag;
+        } else if (movement == 2) {
+            out << "," << (flag ? "RIGHT" : "LEFT");
+        }
+        out << ";";
+    }
+    text = out.str();
+    return true;
+}
+
+string
+instructionFrames(const string& instructions) {
+    const string prefix = "INSTRUCTIONS:";
+    if (instructions.compare(0, prefix.size(), prefix) != 0) {
+        return instructions;
+    }
+    // The instructions of the robots are separated by '|', an empty robot
+    // gets an empty frame.
+    string robots = instructions.substr(prefix.size());
+    stringstream out;
+    out << "FRAMES:";
+    size_t begin = 0;
+    while (true) {
+        size_t end = robots.find('|', begin);
+        string frame;
+        if (!encodeInstructions(robots.substr(begin, end == string::npos ? string::npos : end - begin),
+                                frame)) {
+            return instructions;
+        }
+        static const char hex[] = "0123456789abcdef";
+        for (unsigned int k = 0; k < frame.size(); k++) {
+            out << hex[(unsigned char) frame[k] >> 4] << hex[frame[k] & 15];
+        }
+        if (end == string::npos) {
+            break;
+        }
+        out << "|";
+        begin = end + 1;
+    }
+    return out.str();
+}
+
+bool
+frameInstructions(const string& frames, string& instructions) {
+    const string prefix = "FRAMES:";
+    if (frames.compare(0, prefix.size(), prefix) != 0) {
+        return false;
+    }
+    string hexFrames = frames.substr(prefix.size());
+    instructions = "INSTRUCTIONS:";
+    size_t begin = 0;
+    while (true) {
+        size_t end = hexFrames.find('|', begin);
+        string hexFrame = hexFrames.substr(begin, end == string::npos ? string::npos : end - begin);
+        if (hexFrame.size() % 2 != 0
+            || hexFrame.find_first_not_of("0123456789abcdefABCDEF") != string::npos) {
+            return false;
+        }
+        string frame;
+        for (unsigned int k = 0; k < hexFrame.size(); k += 2) {
+            frame += (char) strtol(hexFrame.substr(k, 2).c_str(), NULL, 16);
+        }
+        string text;
+        if (!decodeInstructions(frame, text)) {
+            return false;
+        }
+        instructions += text;
+        if (end == string::npos) {
+            return true;
+        }
+        instructions += "|";
+        begin = end + 1;
+    }
+}
@@ -0,0 +1,49 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main author:
+ *     Michael Brendle <michaelbrendle@me.com>
+ *
+ */
+
+#ifndef __WAREHOUSE_INSTRUCTIONCODEC_HH__
+#define __WAREHOUSE_INSTRUCTIONCODEC_HH__
+
+#include <string>
+
+/* -------------------------------
+ *  BINARY INSTRUCTIONS
+ *
+ *  The instructions of a robot (TURN,1,LEFT;FORWARD,3,0;PICK,1;) in a
+ *  frame for the Bluetooth link to the robot:
+ *
+ *    0xB5, length, instructions (length bytes), CRC-8 of length and
+ *    instructions (polynomial 0x07)
+ *
+ *  An instruction is one byte: the movement in the bits 7-5 (FORWARD 0,
+ *  BACKWARD 1, TURN 2, PICK 3, DROP 4, SYNC 5, as Instruction.MOVEMENT of
+ *  the robot), the value (1 to 15) in the bits 4-1 and the flag in the bit 0
+ *  (the left sensor of a FORWARD, RIGHT of a TURN). A value of 0 in the
+ *  bits 4-1 means, that the value (0 to 255) is in a second byte.
+ *  -------------------------------
+ */
+
+/// First byte of a frame. It is no ASCII character, so the robot can tell
+/// a frame from the text instructions.
+const unsigned char frameStart = 0xB5;
+
+/// Encodes the text instructions of one robot into the frame \a frame.
+/// Returns false, if an instruction is unknown or the frame is too long.
+bool encodeInstructions(const std::string& text, std::string& frame);
+/// Decodes the frame \a frame into the text instructions of one robot.
+/// Returns false, if the frame is incomplete or its checksum is wrong.
+bool decodeInstructions(const std::string& frame, std::string& text);
+
+/// Returns the line FRAMES:<hex>|<hex>.. with one frame per robot for the
+/// line INSTRUCTIONS:..|.. of a plan. The text line is returned, if the
+/// instructions of a robot cannot be encoded.
+std::string instructionFrames(const std::string& instructions);
+/// Decodes the line FRAMES:.. into the line INSTRUCTIONS:.. of a plan.
+/// Returns false, if a frame cannot be decoded.
+bool frameInstructions(const std::string& frames, std::string& instructions);
+
+#endif
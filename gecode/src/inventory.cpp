@@ -0,0 +1,219 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main author:
+ *     Michael Brendle <michaelbrendle@me.com>
+ *
+ */
+
+#include "inventory.hh"
+#include "slotindex.hh"
+
+#include <cstdlib>
+
+using namespace std;
+
+Inventory::Inventory(const WarehouseSnapshot& s0)
+  : s(s0) {
+    index(s.goods);
+}
+
+Inventory::Inventory(const WarehouseSnapshot& s0, const vector<WarehouseGood>& goods)
+  : s(s0) {
+    index(goods);
+}
+
+/// If two goods stand at the same position (e.g. an added good at an
+/// occupied dock), the position is indexed with the first one.
+void
+Inventory::index(const vector<WarehouseGood>& goods) {
+    occupiedBits = sectionBits = warehouseBits = 0;
+    for (int p = 0; p < 49; p++) {
+        goodAt[p] = -1;
+        warehouseAt[p] = -1;
+    }
+    for (unsigned int i = 0; i < s.sections.size(); i++) {
+        int p = s.sections[i].position;
+        if (p >= 0 && p < 49) {
+            sectionBits |= 1ULL << p;
+        }
+    }
+    for (unsigned int j = 0; j < s.warehousePosition.size(); j++) {
+        int p = s.warehousePosition[j];
+        if (p >= 0 && p < 49) {
+            warehouseBits |= 1ULL << p;
+            warehouseAt[p] = j;
+        }
+    }
+    for (unsigned int g = 0; g < goods.size(); g++) {
+        names.push_back(goods[g].name);
+        positions.push_back(goods[g].position);
+        tempMins.push_back(goods[g].tempMin);
+        tempMaxs.push_back(goods[g].tempMax);
+        lightMins.push_back(goods[g].lightMin);
+        lightMaxs.push_back(goods[g].lightMax);
+        byName[goods[g].name].push_back(g);
+        int p = goods[g].position;
+        if (p >= 0 && p < 49 && goodAt[p] < 0) {
+            goodAt[p] = g;
+            occupiedBits |= 1ULL << p;
+        }
+    }
+}
+
+int
+Inventory::size(void) const {
+    return positions.size();
+}
+
+const string&
+Inventory::name(int g) const {
+    return names[g];
+}
+
+int
+Inventory::position(int g) const {
+    return positions[g];
+}
+
+WarehouseGood
+Inventory::good(int g) const {
+    WarehouseGood good;
+    good.name = names[g];
+    good.position = positions[g];
+    good.tempMin = tempMins[g];
+    good.tempMax = tempMaxs[g];
+    good.lightMin = lightMins[g];
+    good.lightMax = lightMaxs[g];
+    return good;
+}
+
+int
+Inventory::at(int position) const {
+    if (position < 0 || position >= 49) {
+        return -1;
+    }
+    return goodAt[position];
+}
+
+vector<int>
+Inventory::find(const string& name) const {
+    unordered_map<string, vector<int> >::const_iterator it = byName.find(name);
+    if (it == byName.end()) {
+        return vector<int>();
+    }
+    return it->second;
+}
+
+bool
+Inventory::occupied(int position) const {
+    return position >= 0 && position < 49 && (occupiedBits >> position) & 1;
+}
+
+int
+Inventory::warehouse(int position) const {
+    if (position < 0 || position >= 49) {
+        return -1;
+    }
+    return warehouseAt[position];
+}
+
+vector<int>
+Inventory::freeSlots(bool garage) const {
+    unsigned long long free = (garage ? sectionBits : warehouseBits) & ~occupiedBits;
+    vector<int> slots;
+    for (int p = 0; free != 0; p++, free >>= 1) {
+        if (free & 1) {
+            slots.push_back(p);
+        }
+    }
+    return slots;
+}
+
+bool
+Inventory::fits(int g, int warehouse) const {
+    return tempMins[g] <= s.warehouseTemp[warehouse] && s.warehouseTemp[warehouse] <= tempMaxs[g]
+      && lightMins[g] <= s.warehouseLight[warehouse] && s.warehouseLight[warehouse] <= lightMaxs[g];
+}
+
+bool
+Inventory::misplaced(int g) const {
+    int w = warehouse(positions[g]);
+    return w < 0 || !fits(g, w);
+}
+
+vector<int>
+Inventory::outOfRange(void) const {
+    vector<int> goods;
+    for (int g = 0; g < size(); g++) {
+        if (misplaced(g)) {
+            goods.push_back(g);
+        }
+    }
+    return goods;
+}
+
+Json::Value
+Inventory::json(int g) const {
+    Json::Value good;
+    good["name"] = names[g];
+    good["x_coord"] = positions[g] % 7;
+    good["y_coord"] = positions[g] / 7;
+    good["desiredTemperature"]["min"] = tempMins[g];
+    good["desiredTemperature"]["max"] = tempMaxs[g];
+    good["desiredLighting"]["min"] = lightMins[g];
+    good["desiredLighting"]["max"] = lightMaxs[g];
+    good["misplaced"] = misplaced(g);
+    return good;
+}
+
+Json::Value
+Inventory::query(const Json::Value& q, const SlotIndex* slots) const {
+    string kind = q.get("query", "").asString();
+    Json::Value result(Json::arrayValue);
+    if (kind == "where") {
+        vector<int> goods = find(q.get("name", "").asString());
+        for (unsigned int k = 0; k < goods.size(); k++) {
+            result.append(json(goods[k]));
+        }
+    } else if (kind == "at") {
+        int g = at(atoi(q.get("y_coord", 0).asString().c_str()) * 7
+                   + atoi(q.get("x_coord", 0).asString().c_str()));
+        if (g >= 0) {
+            result.append(json(g));
+        }
+    } else if (kind == "free") {
+        vector<int> slots = freeSlots(q.get("garage", false).asBool());
+        for (unsigned int k = 0; k < slots.size(); k++) {
+            Json::Value slot;
+            slot["x_coord"] = slots[k] % 7;
+            slot["y_coord"] = slots[k] / 7;
+            result.append(slot);
+        }
+    } else if (kind == "slots") {
+        WarehouseGood good;
+        good.position = -1;
+        good.tempMin = atoi(q.get("tempMin", 0).asString().c_str());
+        good.tempMax = atoi(q.get("tempMax", 0).asString().c_str());
+        good.lightMin = atoi(q.get("lightMin", 0).asString().c_str());
+        good.lightMax = atoi(q.get("lightMax", 0).asString().c_str());
+        vector<int> fitting = slots != NULL ? slots->compatibleFree(good, *this)
+          : SlotIndex(s).compatibleFree(good, *this);
+        for (unsigned int k = 0; k < fitting.size(); k++) {
+            Json::Value slot;
+            slot["x_coord"] = fitting[k] % 7;
+            slot["y_coord"] = fitting[k] / 7;
+            result.append(slot);
+        }
+    } else if (kind == "misplaced") {
+        vector<int> goods = outOfRange();
+        for (unsigned int k = 0; k < goods.size(); k++) {
+            result.append(json(goods[k]));
+        }
+    } else {
+        result = Json::Value(Json::objectValue);
+        result["goods"] = size();
+        result["free"] = (int) freeSlots().size();
+        result["misplaced"] = (int) outOfRange().size();
+    }
+    return result;
+}
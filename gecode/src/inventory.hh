@@ -0,0 +1,104 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main author:
+ *     Michael Brendle <michaelbrendle@me.com>
+ *
+ */
+
+#ifndef __WAREHOUSE_INVENTORY_HH__
+#define __WAREHOUSE_INVENTORY_HH__
+
+#include "planner.hh"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class SlotIndex;
+
+/* -------------------------------
+ *  INVENTORY
+ *
+ *  The goods of a snapshot with indexes by position and by name and a
+ *  bitmap of the occupied places. The fields of the goods are stored in
+ *  one array per field. All lookups by position are O(1).
+ *  -------------------------------
+ */
+
+class Inventory {
+protected:
+  std::vector<std::string> names;
+  std::vector<int> positions;
+  std::vector<int> tempMins;
+  std::vector<int> tempMaxs;
+  std::vector<int> lightMins;
+  std::vector<int> lightMaxs;
+
+  /// Index of the good at each position, -1 for none.
+  int goodAt[49];
+  /// Index of the Warehouse place at each position, -1 for none.
+  int warehouseAt[49];
+  /// Goods by name, a lookup is O(1) on average.
+  std::unordered_map<std::string, std::vector<int> > byName;
+
+  /// Bit p is set, if the position p is occupied, a section, or a
+  /// Warehouse place.
+  unsigned long long occupiedBits;
+  unsigned long long sectionBits;
+  unsigned long long warehouseBits;
+
+  const WarehouseSnapshot& s;
+
+  void index(const std::vector<WarehouseGood>& goods);
+public:
+  /// Inventory of the goods of \a s.
+  Inventory(const WarehouseSnapshot& s);
+  /// Inventory of \a goods (e.g. the goods of a job) in the layout of \a s.
+  Inventory(const WarehouseSnapshot& s, const std::vector<WarehouseGood>& goods);
+
+  /// Number of goods.
+  int size(void) const;
+  const std::string& name(int g) const;
+  int position(int g) const;
+  /// The good \a g with all its fields.
+  WarehouseGood good(int g) const;
+
+  /// Index of the good at \a position, -1, if the position is free.
+  int at(int position) const;
+  /// Indexes of the goods named \a name.
+  std::vector<int> find(const std::string& name) const;
+  /// Returns true, if \a position is occupied.
+  bool occupied(int position) const;
+  /// Index of the Warehouse place at \a position (see WarehouseSnapshot),
+  /// -1 for a garage place or no section.
+  int warehouse(int position) const;
+
+  /// Free Warehouse places, or all free sections, if \a garage.
+  std::vector<int> freeSlots(bool garage = false) const;
+  /// Returns true, if the good \a g stands at a garage place or at a
+  /// Warehouse place that does not fit its temperature and light range.
+  bool misplaced(int g) const;
+  /// Returns true, if the good \a g fits the Warehouse place \a warehouse.
+  bool fits(int g, int warehouse) const;
+  /// Indexes of the misplaced goods.
+  std::vector<int> outOfRange(void) const;
+
+  /// JSON of the good \a g, as in sections.js with its coordinates.
+  Json::Value json(int g) const;
+  /// Answers the query \a q of the web server:
+  ///
+  ///   {"query":"where","name":..}   the goods named name
+  ///   {"query":"at","x_coord":..,"y_coord":..}  the good at a place
+  ///   {"query":"free"}              the free Warehouse places
+  ///   {"query":"slots","tempMin":..,"tempMax":..,"lightMin":..,"lightMax":..}
+  ///                                 the free Warehouse places that fit
+  ///                                 these ranges (see SlotIndex)
+  ///   {"query":"misplaced"}         the goods out of their range
+  ///
+  /// and without a query the number of goods and of free places. The
+  /// slots are found with \a slots, if it is given, e.g. the index of
+  /// the sensor stream; otherwise the index is built for this query.
+  Json::Value query(const Json::Value& q, const SlotIndex* slots = NULL) const;
+};
+
+#endif
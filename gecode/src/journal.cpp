@@ -0,0 +1,451 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main author:
+ *     Michael Brendle <michaelbrendle@me.com>
+ *
+ */
+
+#include "journal.hh"
+#include "jsondecoder.hh"
+#include "jsonencoder.hh"
+#include "planner.hh"
+
+#include <cstring>
+#include <sstream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+/// One line of the journal.
+class JournalOp {
+public:
+  string op;
+  unsigned int seq;
+  int from;
+  int to;
+  int at;
+  int robot;
+  int sensor;
+  WarehouseGood good;
+  WarehouseRobot pose;
+  WarehouseSensor reading;
+  FileStamp stamps[3];
+};
+
+static bool sameGood(const WarehouseGood& a, const WarehouseGood& b) {
+    return a.name == b.name && a.tempMin == b.tempMin && a.tempMax == b.tempMax
+      && a.lightMin == b.lightMin && a.lightMax == b.lightMax;
+}
+
+StateJournal::StateJournal(const string& file0)
+  : file(file0), length(0), measured(false) {}
+
+bool
+StateJournal::sameLayout(const WarehouseSnapshot& a, const WarehouseSnapshot& b) {
+    if (a.robotArray != b.robotArray || a.robots.size() != b.robots.size()
+        || a.sensors.size() != b.sensors.size() || a.sections.size() != b.sections.size()) {
+        return false;
+    }
+    for (unsigned int i = 0; i < a.sensors.size(); i++) {
+        if (a.sensors[i].id != b.sensors[i].id) {
+            return false;
+        }
+    }
+    for (unsigned int i = 0; i < a.sections.size(); i++) {
+        if (a.sections[i].position != b.sections[i].position
+            || a.sections[i].sensor != b.sections[i].sensor
+            || a.sections[i].dock != b.sections[i].dock) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+
+
+/* -------------------------------
+ *  REPLAY
+ *  -------------------------------
+ */
+
+static void decodeGood(JsonDecoder& d, WarehouseGood& good) {
+    string key;
+    if (d.beginObject()) {
+        while (d.nextMember(key)) {
+            if (key == "name") {
+                good.name = d.readString();
+            } else if (key == "tempMin") {
+                good.tempMin = d.readInt();
+            } else if (key == "tempMax") {
+                good.tempMax = d.readInt();
+            } else if (key == "lightMin") {
+                good.lightMin = d.readInt();
+            } else if (key == "lightMax") {
+                good.lightMax = d.readInt();
+            } else {
+                d.skip();
+            }
+        }
+    }
+}
+
+static void decodeStamps(JsonDecoder& d, FileStamp stamps[3]) {
+    memset(stamps, 0, 3 * sizeof(FileStamp));
+    int k = 0;
+    if (d.beginArray()) {
+        while (d.nextElement()) {
+            if (k < 3 && d.beginArray()) {
+                int64_t values[4] = {0, 0, 0, 0};
+                int v = 0;
+                while (d.nextElement()) {
+                    long long value = d.readLong();
+                    if (v < 4) {
+                        values[v++] = value;
+                    }
+                }
+                stamps[k].mtime = values[0];
+                stamps[k].mtimeNsec = values[1];
+                stamps[k].size = values[2];
+                stamps[k].inode = values[3];
+                k++;
+            } else {
+                d.skip();
+            }
+        }
+    }
+}
+
+static JournalOp decodeOp(JsonDecoder& d) {
+    JournalOp op;
+    op.seq = 0;
+    op.from = op.to = op.at = op.robot = op.sensor = -1;
+    op.good.position = op.good.tempMin = op.good.tempMax = 0;
+    op.good.lightMin = op.good.lightMax = 0;
+    op.pose.position = op.pose.orientation = 0;
+    op.pose.backward = false;
+    op.reading.id = op.reading.temperature = op.reading.lighting = 0;
+    memset(op.stamps, 0, sizeof(op.stamps));
+    string key;
+    if (d.beginObject()) {
+        while (d.nextMember(key)) {
+            if (key == "seq") {
+                op.seq = d.readInt();
+            } else if (key == "op") {
+                op.op = d.readString();
+            } else if (key == "from") {
+                op.from = d.readInt(-1);
+            } else if (key == "to") {
+                op.to = d.readInt(-1);
+            } else if (key == "at") {
+                op.at = d.readInt(-1);
+            } else if (key == "robot") {
+                op.robot = d.readInt(-1);
+            } else if (key == "sensor") {
+                op.sensor = d.readInt(-1);
+            } else if (key == "good") {
+                decodeGood(d, op.good);
+            } else if (key == "position") {
+                op.pose.position = d.readInt();
+            } else if (key == "orientation") {
+                op.pose.orientation = d.readInt();
+            } else if (key == "backward") {
+                op.pose.backward = d.readBool();
+            } else if (key == "temperature") {
+                op.reading.temperature = d.readInt();
+            } else if (key == "lighting") {
+                op.reading.lighting = d.readInt();
+            } else if (key == "stamps") {
+                decodeStamps(d, op.stamps);
+            } else {
+                d.skip();
+            }
+        }
+    }
+    return op;
+}
+
+/// Applies the change \a ops to \a s. The goods of all sources are taken
+/// before any destination is filled, so that the order of the moves of a
+/// change does not matter.
+static void applyChange(WarehouseSnapshot& s, const vector<JournalOp>& ops) {
+    int sectionAt[49];
+    for (int p = 0; p < 49; p++) {
+        sectionAt[p] = -1;
+    }
+    for (unsigned int i = 0; i < s.sections.size(); i++) {
+        if (s.sections[i].position >= 0 && s.sections[i].position < 49) {
+            sectionAt[s.sections[i].position] = i;
+        }
+    }
+    vector<WarehouseGood> before;
+    for (unsigned int i = 0; i < s.sections.size(); i++) {
+        before.push_back(s.sections[i].good);
+    }
+    for (unsigned int k = 0; k < ops.size(); k++) {
+        const JournalOp& op = ops[k];
+        int source = (op.op == "move") ? op.from : (op.op == "remove") ? op.at : -1;
+        if (source >= 0 && source < 49 && sectionAt[source] >= 0) {
+            WarehouseSection& section = s.sections[sectionAt[source]];
+            section.occupied = false;
+            section.text.clear();
+        }
+    }
+    for (unsigned int k = 0; k < ops.size(); k++) {
+        const JournalOp& op = ops[k];
+        if (op.op == "robot") {
+            if (op.robot >= 0 && op.robot < (int) s.robots.size()) {
+                s.robots[op.robot] = op.pose;
+            }
+        } else if (op.op == "sensor") {
+            if (op.sensor >= 0 && op.sensor < (int) s.sensors.size()) {
+                s.sensors[op.sensor].temperature = op.reading.temperature;
+                s.sensors[op.sensor].lighting = op.reading.lighting;
+            }
+        } else if (op.op == "move" || op.op == "add") {
+            int source = (op.op == "move") ? op.from : -1;
+            int target = (op.op == "move") ? op.to : op.at;
+            if (target < 0 || target >= 49 || sectionAt[target] < 0) {
+                continue;
+            }
+            WarehouseSection& section = s.sections[sectionAt[target]];
+            if (source >= 0 && source < 49 && sectionAt[source] >= 0) {
+                section.good = before[sectionAt[source]];
+            } else {
+                section.good = op.good;
+            }
+            section.good.position = section.position;
+            section.occupied = true;
+            section.text.clear();
+        }
+    }
+}
+
+void
+StateJournal::replay(WarehouseSnapshot& s, FileStamp stamps[3]) {
+    MappedFile data(file);
+    JsonDecoder d(data.data(), data.size());
+    vector<JournalOp> pending;
+    length = 0;
+    measured = true;
+    while (d.peek() == '{') {
+        JournalOp op = decodeOp(d);
+        if (!d.ok()) {
+            break;
+        }
+        if (!pending.empty() && pending[0].seq != op.seq) {
+            pending.clear();
+        }
+        if (op.op != "commit") {
+            pending.push_back(op);
+            continue;
+        }
+        length = d.position() - data.data();
+        if (length < data.size() && data.data()[length] == '\n') {
+            length++;
+        }
+        if (op.seq > s.journalSeq) {
+            applyChange(s, pending);
+            s.journalSeq = op.seq;
+            memcpy(stamps, op.stamps, sizeof(op.stamps));
+        }
+        pending.clear();
+    }
+}
+
+
+
+
+/* -------------------------------
+ *  APPENDING A CHANGE
+ *  -------------------------------
+ */
+
+static void encodeOp(JsonEncoder& e, unsigned int seq, const char* op) {
+    e.beginObject();
+    e.key("seq");
+    e.value((int) seq);
+    e.key("op");
+    e.value(op);
+}
+
+static void encodeGood(JsonEncoder& e, const WarehouseGood& good) {
+    e.key("good");
+    e.beginObject();
+    e.key("name");
+    e.value(good.name);
+    e.key("tempMin");
+    e.value(good.tempMin);
+    e.key("tempMax");
+    e.value(good.tempMax);
+    e.key("lightMin");
+    e.value(good.lightMin);
+    e.key("lightMax");
+    e.value(good.lightMax);
+    e.endObject();
+}
+
+/// Length of the journal up to the end of its last commit line, if the
+/// journal was not replayed before.
+static size_t committedLength(const string& file) {
+    MappedFile data(file);
+    const char* text = data.data();
+    size_t length = 0;
+    size_t lineStart = 0;
+    for (size_t i = 0; i < data.size(); i++) {
+        if (text[i] != '\n') {
+            continue;
+        }
+        string line(text + lineStart, i - lineStart);
+        if (line.find("\"op\":\"commit\"") != string::npos) {
+            length = i + 1;
+        }
+        lineStart = i + 1;
+    }
+    return length;
+}
+
+bool
+StateJournal::append(unsigned int seq, const WarehouseSnapshot& a,
+                     const WarehouseSnapshot& b, const FileStamp stamps[3]) {
+    stringstream lines;
+
+    // The goods that left a section and the goods that came to a section.
+    // A good that left one section and came to another one was moved.
+    vector<int> from;
+    vector<int> to;
+    for (unsigned int i = 0; i < a.sections.size(); i++) {
+        const WarehouseSection& sa = a.sections[i];
+        const WarehouseSection& sb = b.sections[i];
+        bool same = sa.occupied == sb.occupied
+          && (!sa.occupied || sameGood(sa.good, sb.good));
+        if (sa.occupied && !same) {
+            from.push_back(i);
+        }
+        if (sb.occupied && !same) {
+            to.push_back(i);
+        }
+    }
+    for (unsigned int k = 0; k < to.size(); k++) {
+        const WarehouseSection& sb = b.sections[to[k]];
+        JsonEncoder e(lines, false);
+        int source = -1;
+        for (unsigned int f = 0; f < from.size(); f++) {
+            if (from[f] >= 0 && sameGood(a.sections[from[f]].good, sb.good)) {
+                source = from[f];
+                from[f] = -1;
+                break;
+            }
+        }
+        if (source >= 0) {
+            encodeOp(e, seq, "move");
+            e.key("from");
+            e.value(a.sections[source].position);
+            e.key("to");
+            e.value(sb.position);
+        } else {
+            encodeOp(e, seq, "add");
+            e.key("at");
+            e.value(sb.position);
+            encodeGood(e, sb.good);
+        }
+        e.endObject();
+        lines << '\n';
+    }
+    for (unsigned int f = 0; f < from.size(); f++) {
+        if (from[f] >= 0) {
+            JsonEncoder e(lines, false);
+            encodeOp(e, seq, "remove");
+            e.key("at");
+            e.value(a.sections[from[f]].position);
+            e.endObject();
+            lines << '\n';
+        }
+    }
+
+    for (unsigned int r = 0; r < b.robots.size(); r++) {
+        const WarehouseRobot& ra = a.robots[r];
+        const WarehouseRobot& rb = b.robots[r];
+        if (ra.position != rb.position || ra.orientation != rb.orientation
+            || ra.backward != rb.backward) {
+            JsonEncoder e(lines, false);
+            encodeOp(e, seq, "robot");
+            e.key("robot");
+            e.value((int) r);
+            e.key("position");
+            e.value(rb.position);
+            e.key("orientation");
+            e.value(rb.orientation);
+            e.key("backward");
+            e.value(rb.backward);
+            e.endObject();
+            lines << '\n';
+        }
+    }
+
+    for (unsigned int i = 0; i < b.sensors.size(); i++) {
+        if (a.sensors[i].temperature != b.sensors[i].temperature
+            || a.sensors[i].lighting != b.sensors[i].lighting) {
+            JsonEncoder e(lines, false);
+            encodeOp(e, seq, "sensor");
+            e.key("sensor");
+            e.value((int) i);
+            e.key("temperature");
+            e.value(b.sensors[i].temperature);
+            e.key("lighting");
+            e.value(b.sensors[i].lighting);
+            e.endObject();
+            lines << '\n';
+        }
+    }
+
+    JsonEncoder e(lines, false);
+    encodeOp(e, seq, "commit");
+    e.key("stamps");
+    e.beginArray();
+    for (int k = 0; k < 3; k++) {
+        e.beginArray();
+        e.value((long long) stamps[k].mtime);
+        e.value((long long) stamps[k].mtimeNsec);
+        e.value((long long) stamps[k].size);
+        e.value((long long) stamps[k].inode);
+        e.endArray();
+    }
+    e.endArray();
+    e.endObject();
+    lines << '\n';
+
+    // The whole change is written at once and flushed to disk, before the
+    // state counts as changed.
+    if (!measured) {
+        length = committedLength(file);
+        measured = true;
+    }
+    int fd = open(file.c_str(), O_WRONLY | O_CREAT, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    string text = lines.str();
+    bool written = ftruncate(fd, length) == 0
+      && lseek(fd, length, SEEK_SET) == (off_t) length
+      && ::write(fd, text.data(), text.size()) == (ssize_t) text.size()
+      && fsync(fd) == 0;
+    close(fd);
+    if (written) {
+        length += text.size();
+    }
+    return written;
+}
+
+bool
+StateJournal::clear(void) {
+    AtomicFile empty(file);
+    if (!empty.commit()) {
+        return false;
+    }
+    length = 0;
+    measured = true;
+    return true;
+}
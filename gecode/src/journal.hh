@@ -0,0 +1,73 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main author:
+ *     Michael Brendle <michaelbrendle@me.com>
+ *
+ */
+
+#ifndef __WAREHOUSE_JOURNAL_HH__
+#define __WAREHOUSE_JOURNAL_HH__
+
+#include "snapshotfile.hh"
+
+#include <string>
+
+class WarehouseSnapshot;
+
+/* -------------------------------
+ *  STATE JOURNAL
+ *
+ *  Append-only record of the changes of the state since the binary
+ *  snapshot file. Each change is a group of JSON lines with the same
+ *  number "seq":
+ *
+ *    {"seq":4,"op":"move","from":12,"to":20}
+ *    {"seq":4,"op":"add","at":8,"good":{...}}
+ *    {"seq":4,"op":"remove","at":15}
+ *    {"seq":4,"op":"robot","robot":0,"position":..,"orientation":..,"backward":..}
+ *    {"seq":4,"op":"sensor","sensor":0,"temperature":..,"lighting":..}
+ *    {"seq":4,"op":"commit","stamps":[...]}
+ *
+ *  The commit line holds the stamps of the JSON files after the change. A
+ *  change without its commit line (e.g. after a crash) is not replayed.
+ *
+ *  The planner is the only writer of the journal. It keeps the length of
+ *  the committed changes, so that an append only writes the new change.
+ *  -------------------------------
+ */
+
+/// Number of changes in the journal, after which the state is compacted
+/// into a new binary snapshot file.
+const unsigned int journalCompaction = 64;
+
+class StateJournal {
+protected:
+  std::string file;
+  /// Length of the journal up to the end of its last commit line, if it
+  /// was measured already.
+  size_t length;
+  bool measured;
+public:
+  StateJournal(const std::string& file = "journal.log");
+
+  /// Returns true, if the changes from \a a to \a b can be recorded: both
+  /// have the same robots, sensors and sections, only the goods, the robot
+  /// poses and the sensor values may differ.
+  static bool sameLayout(const WarehouseSnapshot& a, const WarehouseSnapshot& b);
+
+  /// Replays the committed changes after s.journalSeq on \a s and updates
+  /// s.journalSeq. The stamps of the last replayed change are copied to
+  /// \a stamps.
+  void replay(WarehouseSnapshot& s, FileStamp stamps[3]);
+  /// Appends the changes from \a a to \a b as change \a seq, with the
+  /// stamps of the JSON files of \a b. An incomplete change at the end of
+  /// the journal is cut off before. Returns false, if the journal could
+  /// not be written.
+  bool append(unsigned int seq, const WarehouseSnapshot& a,
+              const WarehouseSnapshot& b, const FileStamp stamps[3]);
+  /// Removes all changes, after they were compacted into the binary
+  /// snapshot file.
+  bool clear(void);
+};
+
+#endif
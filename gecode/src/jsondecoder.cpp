@@ -0,0 +1,323 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main author:
+ *     Michael Brendle <michaelbrendle@me.com>
+ *
+ */
+
+#include "jsondecoder.hh"
+
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+/* -------------------------------
+ *  MAPPED FILE
+ *  -------------------------------
+ */
+
+MappedFile::MappedFile(const string& file)
+  : _data(""), _size(0), mapped(NULL) {
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* m = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m != MAP_FAILED) {
+            mapped = m;
+            _data = static_cast<const char*>(m);
+            _size = st.st_size;
+        }
+    }
+    close(fd);
+
+    // For example a pipe cannot be mapped.
+    if (mapped == NULL) {
+        std::ifstream in(file.c_str(), std::ios::in | std::ios::binary);
+        stringstream contents;
+        contents << in.rdbuf();
+        copy = contents.str();
+        _data = copy.data();
+        _size = copy.size();
+    }
+}
+
+MappedFile::~MappedFile(void) {
+    if (mapped != NULL) {
+        munmap(mapped, _size);
+    }
+}
+
+const char*
+MappedFile::data(void) const {
+    return _data;
+}
+
+size_t
+MappedFile::size(void) const {
+    return _size;
+}
+
+
+
+
+/* -------------------------------
+ *  JSON DECODER
+ *  -------------------------------
+ */
+
+JsonDecoder::JsonDecoder(const char* data, size_t size)
+  : p(data), end(data + size), failed(false) {}
+
+bool
+JsonDecoder::ok(void) const {
+    return !failed;
+}
+
+char
+JsonDecoder::next(void) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+        p++;
+    }
+    if (failed || p >= end) {
+        return 0;
+    }
+    return *p;
+}
+
+char
+JsonDecoder::peek(void) {
+    char c = next();
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        return '0';
+    }
+    return c;
+}
+
+bool
+JsonDecoder::literal(const char* word) {
+    size_t n = strlen(word);
+    if ((size_t) (end - p) < n || strncmp(p, word, n) != 0) {
+        failed = true;
+        return false;
+    }
+    p += n;
+    return true;
+}
+
+string
+JsonDecoder::number(void) {
+    const char* begin = p;
+    while (p < end && (*p == '-' || *p == '+' || *p == '.' || *p == 'e'
+                       || *p == 'E' || (*p >= '0' && *p <= '9'))) {
+        p++;
+    }
+    return string(begin, p);
+}
+
+const char*
+JsonDecoder::position(void) const {
+    return p;
+}
+
+bool
+JsonDecoder::beginObject(void) {
+    if (peek() != '{') {
+        skip();
+        return false;
+    }
+    p++;
+    return true;
+}
+
+bool
+JsonDecoder::beginArray(void) {
+    if (peek() != '[') {
+        skip();
+        return false;
+    }
+    p++;
+    return true;
+}
+
+bool
+JsonDecoder::nextMember(string& key) {
+    char c = next();
+    if (c == ',') {
+        p++;
+        c = next();
+    }
+    if (c != '"') {
+        // The end of the object, or malformed text.
+        if (c == '}') {
+            p++;
+        } else {
+            failed = true;
+        }
+        return false;
+    }
+    key = readString();
+    if (next() != ':') {
+        failed = true;
+        return false;
+    }
+    p++;
+    return true;
+}
+
+bool
+JsonDecoder::nextElement(void) {
+    char c = next();
+    if (c == ',') {
+        p++;
+        c = next();
+    }
+    if (c == ']') {
+        p++;
+        return false;
+    }
+    return c != 0;
+}
+
+int
+JsonDecoder::readInt(int otherwise) {
+    switch (peek()) {
+    case '0':
+        return (int) strtod(number().c_str(), NULL);
+    case '"':
+        return atoi(readString().c_str());
+    case 't':
+        return literal("true") ? 1 : otherwise;
+    case 'f':
+        return literal("false") ? 0 : otherwise;
+    default:
+        skip();
+        return otherwise;
+    }
+}
+
+long long
+JsonDecoder::readLong(long long otherwise) {
+    if (peek() != '0') {
+        skip();
+        return otherwise;
+    }
+    return strtoll(number().c_str(), NULL, 10);
+}
+
+bool
+JsonDecoder::readBool(bool otherwise) {
+    switch (peek()) {
+    case 't':
+        return literal("true") ? true : otherwise;
+    case 'f':
+        return literal("false") ? false : otherwise;
+    default:
+        skip();
+        return otherwise;
+    }
+}
+
+string
+JsonDecoder::readString(void) {
+    if (peek() != '"') {
+        skip();
+        return "";
+    }
+    p++;
+    string s;
+    while (p < end && *p != '"') {
+        if (*p != '\\') {
+            s += *p++;
+            continue;
+        }
+        p++;
+        if (p >= end) {
+            break;
+        }
+        char c = *p++;
+        switch (c) {
+        case 'b': s += '\b'; break;
+        case 'f': s += '\f'; break;
+        case 'n': s += '\n'; break;
+        case 'r': s += '\r'; break;
+        case 't': s += '\t'; break;
+        case 'u': {
+            // Code point of the basic plane, encoded as UTF-8.
+            if (end - p < 4) {
+                failed = true;
+                return s;
+            }
+            unsigned int u = strtoul(string(p, p + 4).c_str(), NULL, 16);
+            p += 4;
+            if (u < 0x80) {
+                s += (char) u;
+            } else if (u < 0x800) {
+                s += (char) (0xC0 | (u >> 6));
+                s += (char) (0x80 | (u & 0x3F));
+            } else {
+                s += (char) (0xE0 | (u >> 12));
+                s += (char) (0x80 | ((u >> 6) & 0x3F));
+                s += (char) (0x80 | (u & 0x3F));
+            }
+            break;
+        }
+        default: s += c; break;
+        }
+    }
+    if (p >= end) {
+        failed = true;
+        return s;
+    }
+    p++;
+    return s;
+}
+
+void
+JsonDecoder::skip(void) {
+    string key;
+    switch (peek()) {
+    case '{':
+        p++;
+        while (nextMember(key)) {
+            skip();
+        }
+        break;
+    case '[':
+        p++;
+        while (nextElement()) {
+            skip();
+        }
+        break;
+    case '"':
+        readString();
+        break;
+    case '0':
+        number();
+        break;
+    case 't':
+        literal("true");
+        break;
+    case 'f':
+        literal("false");
+        break;
+    case 'n':
+        literal("null");
+        break;
+    case 0:
+        break;
+    default:
+        failed = true;
+        break;
+    }
+}
@@ -0,0 +1,97 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main author:
+ *     Michael Brendle <michaelbrendle@me.com>
+ *
+ */
+
+#ifndef __WAREHOUSE_JSONDECODER_HH__
+#define __WAREHOUSE_JSONDECODER_HH__
+
+#include <cstddef>
+#include <string>
+
+/* -------------------------------
+ *  STREAMING JSON DECODER
+ *
+ *  The state files are decoded in one pass straight into the structs of
+ *  the planner, without building a Json::Value tree. The reader of a
+ *  file walks its expected schema and skips all other members.
+ *  -------------------------------
+ */
+
+/// A file mapped into memory (read only). If the file cannot be mapped,
+/// it is read into memory instead. A missing file is empty.
+class MappedFile {
+protected:
+  const char* _data;
+  size_t _size;
+  /// Mapped memory, or the copy of the file, if it could not be mapped.
+  void* mapped;
+  std::string copy;
+public:
+  MappedFile(const std::string& file);
+  ~MappedFile(void);
+  const char* data(void) const;
+  size_t size(void) const;
+private:
+  MappedFile(const MappedFile&);
+  MappedFile& operator =(const MappedFile&);
+};
+
+/// Pull decoder for JSON text. Objects and arrays are walked with
+///
+///   if (d.beginObject()) while (d.nextMember(key)) { ... }
+///   if (d.beginArray()) while (d.nextElement()) { ... }
+///
+/// where every member and element must be read or skipped. Malformed
+/// text does not throw: the decoder stops and ok() returns false.
+class JsonDecoder {
+protected:
+  const char* p;
+  const char* end;
+  bool failed;
+
+  /// Skips the white space and returns the next character, 0 at the end.
+  char next(void);
+  /// Reads the literal \a word (true, false, null).
+  bool literal(const char* word);
+  /// Reads the characters of a number.
+  std::string number(void);
+public:
+  JsonDecoder(const char* data, size_t size);
+
+  /// Returns false, if the text was malformed.
+  bool ok(void) const;
+
+  /// Kind of the next value: '{', '[', '"', '0' (number), 't' (true),
+  /// 'f' (false), 'n' (null), or 0 at the end of the text.
+  char peek(void);
+
+  /// Starts an object or an array. Returns false and skips the value, if
+  /// the next value is something else.
+  bool beginObject(void);
+  bool beginArray(void);
+  /// Reads the key of the next member. Returns false at the end of the
+  /// object.
+  bool nextMember(std::string& key);
+  /// Returns false at the end of the array.
+  bool nextElement(void);
+
+  /// Reads an integer: a number, a numeric string or a Boolean. Any other
+  /// value is skipped and gives \a otherwise.
+  int readInt(int otherwise = 0);
+  /// Reads a 64 bit integer, e.g. a file size. Any other value is skipped
+  /// and gives \a otherwise.
+  long long readLong(long long otherwise = 0);
+  /// Reads a Boolean. Any other value is skipped and gives \a otherwise.
+  bool readBool(bool otherwise = false);
+  /// Reads a string. Any other value is skipped and gives an empty string.
+  std::string readString(void);
+  /// Skips the next value.
+  void skip(void);
+  /// Current position in the text, e.g. to keep the text of a value.
+  const char* position(void) const;
+};
+
+#endif
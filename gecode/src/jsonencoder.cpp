@@ -0,0 +1,170 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main author:
+ *     Michael Brendle <michaelbrendle@me.com>
+ *
+ */
+
+#include "jsonencoder.hh"
+#include "jsoncpp/json/json.h"
+
+#include <cstdio>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+/* -------------------------------
+ *  ATOMIC FILE
+ *  -------------------------------
+ */
+
+AtomicFile::AtomicFile(const string& file0)
+  : file(file0), temp(file0 + ".tmp"), committed(false) {
+    out.open(temp.c_str(), std::ofstream::out | std::ofstream::trunc);
+}
+
+AtomicFile::~AtomicFile(void) {
+    if (!committed) {
+        out.close();
+        remove(temp.c_str());
+    }
+}
+
+std::ostream&
+AtomicFile::stream(void) {
+    return out;
+}
+
+bool
+AtomicFile::commit(void) {
+    out.close();
+    if (out.fail()) {
+        return false;
+    }
+    // The data has to be on the disk before the rename, otherwise a crash
+    // may leave an empty file behind.
+    int fd = open(temp.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool synced = fsync(fd) == 0;
+    close(fd);
+    if (!synced || rename(temp.c_str(), file.c_str()) != 0) {
+        return false;
+    }
+    committed = true;
+    return true;
+}
+
+
+
+
+/* -------------------------------
+ *  JSON ENCODER
+ *  -------------------------------
+ */
+
+JsonEncoder::JsonEncoder(std::ostream& out0, bool styled0)
+  : out(out0), styled(styled0), afterKey(false) {}
+
+void
+JsonEncoder::newline(void) {
+    if (styled) {
+        out << '\n' << string(3 * count.size(), ' ');
+    }
+}
+
+void
+JsonEncoder::prefix(void) {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (!count.empty()) {
+        if (count.back()++ > 0) {
+            out << ',';
+        }
+        newline();
+    }
+}
+
+void
+JsonEncoder::close(char c) {
+    int n = count.back();
+    count.pop_back();
+    if (n > 0) {
+        newline();
+    }
+    out << c;
+    if (styled && count.empty()) {
+        out << '\n';
+    }
+}
+
+void
+JsonEncoder::beginObject(void) {
+    prefix();
+    out << '{';
+    count.push_back(0);
+}
+
+void
+JsonEncoder::endObject(void) {
+    close('}');
+}
+
+void
+JsonEncoder::beginArray(void) {
+    prefix();
+    out << '[';
+    count.push_back(0);
+}
+
+void
+JsonEncoder::endArray(void) {
+    close(']');
+}
+
+void
+JsonEncoder::key(const string& k) {
+    prefix();
+    out << Json::valueToQuotedString(k.c_str()) << (styled ? " : " : ":");
+    afterKey = true;
+}
+
+void
+JsonEncoder::value(int i) {
+    prefix();
+    out << i;
+}
+
+void
+JsonEncoder::value(long long i) {
+    prefix();
+    out << i;
+}
+
+void
+JsonEncoder::value(bool b) {
+    prefix();
+    out << (b ? "true" : "false");
+}
+
+void
+JsonEncoder::value(const char* s) {
+    prefix();
+    out << Json::valueToQuotedString(s);
+}
+
+void
+JsonEncoder::value(const string& s) {
+    value(s.c_str());
+}
+
+void
+JsonEncoder::raw(const string& text) {
+    prefix();
+    out << text;
+}
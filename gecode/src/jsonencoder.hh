@@ -0,0 +1,83 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main author:
+ *     Michael Brendle <michaelbrendle@me.com>
+ *
+ */
+
+#ifndef __WAREHOUSE_JSONENCODER_HH__
+#define __WAREHOUSE_JSONENCODER_HH__
+
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/* -------------------------------
+ *  STREAMING JSON ENCODER
+ *
+ *  The state files are written straight from the structs of the planner
+ *  into a temporary file, which then replaces the file. A reader of the
+ *  file sees either the old or the new state, never a half-written one.
+ *  -------------------------------
+ */
+
+/// A file that is written to \a file.tmp and replaces \a file on commit().
+/// Without commit(), the temporary file is removed and \a file stays.
+class AtomicFile {
+protected:
+  std::string file;
+  std::string temp;
+  std::ofstream out;
+  bool committed;
+public:
+  AtomicFile(const std::string& file);
+  ~AtomicFile(void);
+  std::ostream& stream(void);
+  /// Flushes the temporary file to disk and renames it to the file.
+  /// Returns false, if the file could not be written.
+  bool commit(void);
+private:
+  AtomicFile(const AtomicFile&);
+  AtomicFile& operator =(const AtomicFile&);
+};
+
+/// Push encoder for JSON text, the counterpart of JsonDecoder:
+///
+///   e.beginObject(); e.key("x_coord"); e.value(3); e.endObject();
+///
+/// The styled form has the layout of the Json::StyledWriter, the compact
+/// form has no white space.
+class JsonEncoder {
+protected:
+  std::ostream& out;
+  bool styled;
+  /// Number of values so far in each open object or array.
+  std::vector<int> count;
+  /// A key was written, and its value comes next.
+  bool afterKey;
+
+  /// Writes the separator and the indentation before the next value.
+  void prefix(void);
+  void newline(void);
+  void close(char c);
+public:
+  JsonEncoder(std::ostream& out, bool styled = true);
+
+  void beginObject(void);
+  void endObject(void);
+  void beginArray(void);
+  void endArray(void);
+  /// Writes the key of the next member of an object.
+  void key(const std::string& k);
+
+  void value(int i);
+  void value(long long i);
+  void value(bool b);
+  void value(const char* s);
+  void value(const std::string& s);
+  /// Writes the encoded JSON text \a text as it is.
+  void raw(const std::string& text);
+};
+
+#endif
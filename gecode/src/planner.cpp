@@ -0,0 +1,3334 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main author:
+ *     Michael Brendle <michaelbrendle@me.com>
+ *
+ */
+
+#include "planner.hh"
+#include "jsondecoder.hh"
+#include "jsonencoder.hh"
+#include "snapshotfile.hh"
+#include "journal.hh"
+#include "inventory.hh"
+#include "slotindex.hh"
+#include "fitmatrix.hh"
+
+#include <gecode/driver.hh>
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <iomanip>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace Gecode;
+using namespace Gecode::Driver;
+
+/// Maximal number of tasks for a single job (a moving job needs less).
+static const int defaultMaxTasks = 16;
+
+/// Maximal number of tasks for a single moving job.
+static const int movingMaxTasks = 7;
+
+/// Additional tasks for each further pick up and drop pair in a batch.
+static const int batchTasksPerPickDrop = 12;
+
+/// Maximal number of positions an order can be delayed by the sequencing
+/// of the orders, if the order has no own deadline.
+static const int sequenceMaxDelay = 3;
+
+
+class Warehouse : public IntMinimizeSpace {
+protected:
+
+  /// Number of maximal robot tasks, number of goods and number of robots.
+  /// The arrays of the robots hold the variables of all robots, one robot
+  /// after the other (see robotSlice).
+  int maxTasks;
+  int numGoods;
+  int numRobots;
+
+  /// Penalty of a good that is not at a fitting Warehouse place.
+  int penalty;
+
+  /// Array of robotTasks and the corresponding BoolArray.
+  IntVarArray robotTasks;
+  BoolVarArray robotTasksBoolArray;
+
+  /// Array of the cost for each task.
+  IntVarArray robotTasksCost;
+  /// Linear all RobotTaskCost to robotCost.
+  IntVar robotCost;
+
+  /// Array of robotPositions at start and end (0 to 48) and corresponding
+  /// BoolArray at start.
+  /// The positions will be encoded like that (this is the Warehouse).
+  ///
+  ///    42 ------------------------- 48
+  ///    35 ------------------------- 41
+  ///    28 ------------------------- 34
+  ///    21 ------------------------- 27
+  ///    14 ------------------------- 20
+  ///    7 ------------ 10 ---------- 13
+  ///    0 -- 1 -- 2 -- 3 -- 4 -- 5 -- 6
+  ///
+  /// Note that also all inner values, like 8, 9, 11, 12, 15, ..., 47
+  /// are possible.
+  ///
+  IntVarArray robotPositionsStart;
+  IntVarArray robotPositionsEnd;
+  BoolVarArray robotPositionsStartBoolArray;
+
+  /// Array of the difference of the robot position from start to end of
+  /// the task and the temp difference.
+  IntVarArray robotPositionsDiff;
+  IntVarArray robotPositionsDiffTemp;
+
+  /// Array of how many steps the robot will do in this task.
+  IntVarArray robotMovingForward;
+
+  /// Array of robotOrientation: N = 0, E = 1, S = 2, W = 3 at start and end
+  /// and corresponding BoolArray.
+  IntVarArray robotOrientationStart;
+  BoolVarArray robotOrientationStartBoolArray;
+  IntVarArray robotOrientationEnd;
+
+  /// Array of the difference of the robot orientation from start to end of
+  /// the task and the new position end value without mod.
+  IntVarArray robotOrientDiff;
+  IntVarArray robotOrientMod;
+
+  /// Array of Goods at the robot at start and at end of the task.
+  IntVarArray robotGoodsStart;
+  IntVarArray robotGoodsEnd;
+
+  /// Matrix/Array of the positions of the goods at start and at the end.
+  IntVarArray goodsPositionStartArray;
+  IntVarArray goodsPositionEndArray;
+
+  // Goods Penalty cost
+  IntVarArray goodsPenaltyCost;
+  // Totsl Penalty Cost
+  IntVar penaltyCost;
+
+  /// Total cost (want to minimize, doing that with branching).
+  IntVar c;
+
+public:
+  /// Actual model of the layout (the root space). The constraints of the
+  /// job are posted with postJob on a clone of this space.
+  /// The cost of the tasks are the durations of the calibration \a cal.
+  Warehouse(int maxTasks0, int numGoods0, int numRobots0, const Calibration& cal) :
+  maxTasks(maxTasks0), numGoods(numGoods0), numRobots(numRobots0),
+  penalty(cal.penalty),
+  robotTasks(*this,numRobots*maxTasks,0,4),
+  robotTasksBoolArray(*this,numRobots*maxTasks*5,0,1),
+  robotTasksCost(*this,numRobots*maxTasks,0,cal.longest()),
+  robotCost(*this,0,numRobots*maxTasks*cal.longest()),
+  robotPositionsStart(*this,numRobots*maxTasks,0,48),
+  robotPositionsStartBoolArray(*this,numRobots*maxTasks*49,0,1),
+  robotPositionsEnd(*this,numRobots*maxTasks,0,48),
+  robotPositionsDiff(*this,numRobots*maxTasks,-42,42),
+  robotPositionsDiffTemp(*this,numRobots*maxTasks,-7,7),
+  robotMovingForward(*this,numRobots*maxTasks,-1,6),
+  robotOrientationStart(*this,numRobots*maxTasks,0,3),
+  robotOrientationStartBoolArray(*this,numRobots*maxTasks*4,0,1),
+  robotOrientationEnd(*this,numRobots*maxTasks,0,3),
+  robotOrientDiff(*this,numRobots*maxTasks,-1,1),
+  robotOrientMod(*this,numRobots*maxTasks,0,9),
+  robotGoodsStart(*this,numRobots*maxTasks,-1,numGoods-1), // -1 no goods
+  robotGoodsEnd(*this,numRobots*maxTasks,-1,numGoods-1), // -1 no goods
+  goodsPositionStartArray(*this,maxTasks*numGoods,0,48),
+  goodsPositionEndArray(*this,maxTasks*numGoods,0,48),
+  goodsPenaltyCost(*this,numGoods,0,penalty),
+  penaltyCost(*this,0,numGoods*penalty),
+  c(*this,0,numGoods*penalty+(numRobots+1)*maxTasks*cal.longest())
+    {
+
+      /// SETTING UP MATRIZES
+
+      // Setting up the two Matrizes for the positions of the goods at the
+      // start and at the end of the task.
+      Matrix<IntVarArray> goodsPositionStart(goodsPositionStartArray,maxTasks,numGoods);
+      Matrix<IntVarArray> goodsPositionEnd(goodsPositionEndArray,maxTasks,numGoods);
+
+
+      /// CONSTRAINTS OF THE GOODS FOR EACH TASK
+
+      for (int i = 0; i < maxTasks; i++) {
+
+          // End Position of the goods at task i is the start position at
+          // task i + 1.
+          if (i < maxTasks - 1) {
+            for (int j = 0; j < numGoods; j++) {
+                rel(*this, goodsPositionEnd(i,j) == goodsPositionStart(i+1,j));
+            }
+          }
+
+          // Each good is at a different position in the Warehouse.
+          distinct(*this, goodsPositionStart.col(i));
+          distinct(*this, goodsPositionEnd.col(i));
+
+      }
+
+
+      /// CONSTRAINTS OF THE ROBOTS
+
+      // Goods that are carried by a robot in a moving task, for each task,
+      // good and robot (only for more than one robot).
+      BoolVarArgs goodsCarried(maxTasks*numGoods*numRobots);
+
+      for (int r = 0; r < numRobots; r++) {
+          postRobot(r, goodsCarried, cal);
+      }
+
+
+      /// COST
+
+      /// linear all RobotTaskCost to the complete cost.
+      linear(*this, robotTasksCost, IRT_EQ, robotCost);
+
+
+      /// Total cost will be robotCost + goodsPenaltyCost. For more than
+      /// one robot, the makespan (the duration of the longest robot) is
+      /// added, so that the robots share the work.
+      if (numRobots > 1) {
+          IntVar makespan = postRobots(goodsCarried);
+          rel(*this, robotCost + penaltyCost + makespan == c);
+      } else {
+          rel(*this, robotCost + penaltyCost == c);
+      }
+
+
+      /// BRANCHING
+
+      // First branch on the the different tasks.
+      branch(*this, robotTasks, INT_VAR_AFC_SIZE_MIN(), INT_VAL_MIN());
+
+      // Branch then on the number of moving steps for the case of a
+      // moving task.
+      branch(*this, robotMovingForward, INT_VAR_AFC_SIZE_MIN(), INT_VAL_MIN());
+
+      // Branch then on the orientation, left or right turn for the case
+      // of a turning task.
+      branch(*this, robotOrientDiff, INT_VAR_AFC_SIZE_MIN(), INT_VAL_RND(5));
+
+  }
+
+
+
+
+  /// Variables of the robot \a r in the array \a a, which holds \a n
+  /// variables for each robot.
+  template<class Args, class Array>
+  static Args robotSlice(const Array& a, int r, int n) {
+    Args args(n);
+    for (int k = 0; k < n; k++) {
+      args[k] = a[r*n + k];
+    }
+    return args;
+  }
+
+  /// Posts the constraints of the robot \a r for each task. The variables
+  /// of the robot have the same names as the arrays of all robots.
+  void postRobot(int r, BoolVarArgs& goodsCarried, const Calibration& cal) {
+
+      IntVarArgs robotTasks = robotSlice<IntVarArgs>(this->robotTasks, r, maxTasks);
+      BoolVarArgs robotTasksBoolArray = robotSlice<BoolVarArgs>(this->robotTasksBoolArray, r, maxTasks*5);
+      IntVarArgs robotTasksCost = robotSlice<IntVarArgs>(this->robotTasksCost, r, maxTasks);
+      IntVarArgs robotPositionsStart = robotSlice<IntVarArgs>(this->robotPositionsStart, r, maxTasks);
+      BoolVarArgs robotPositionsStartBoolArray = robotSlice<BoolVarArgs>(this->robotPositionsStartBoolArray, r, maxTasks*49);
+      IntVarArgs robotPositionsEnd = robotSlice<IntVarArgs>(this->robotPositionsEnd, r, maxTasks);
+      IntVarArgs robotPositionsDiff = robotSlice<IntVarArgs>(this->robotPositionsDiff, r, maxTasks);
+      IntVarArgs robotPositionsDiffTemp = robotSlice<IntVarArgs>(this->robotPositionsDiffTemp, r, maxTasks);
+      IntVarArgs robotMovingForward = robotSlice<IntVarArgs>(this->robotMovingForward, r, maxTasks);
+      IntVarArgs robotOrientationStart = robotSlice<IntVarArgs>(this->robotOrientationStart, r, maxTasks);
+      BoolVarArgs robotOrientationStartBoolArray = robotSlice<BoolVarArgs>(this->robotOrientationStartBoolArray, r, maxTasks*4);
+      IntVarArgs robotOrientationEnd = robotSlice<IntVarArgs>(this->robotOrientationEnd, r, maxTasks);
+      IntVarArgs robotOrientDiff = robotSlice<IntVarArgs>(this->robotOrientDiff, r, maxTasks);
+      IntVarArgs robotOrientMod = robotSlice<IntVarArgs>(this->robotOrientMod, r, maxTasks);
+      IntVarArgs robotGoodsStart = robotSlice<IntVarArgs>(this->robotGoodsStart, r, maxTasks);
+      IntVarArgs robotGoodsEnd = robotSlice<IntVarArgs>(this->robotGoodsEnd, r, maxTasks);
+
+      /// SETTING UP MATRIZES
+
+      // Setting up the two Matrizes for the positions of the goods at the
+      // start and at the end of the task.
+      Matrix<IntVarArray> goodsPositionStart(goodsPositionStartArray,maxTasks,numGoods);
+      Matrix<IntVarArray> goodsPositionEnd(goodsPositionEndArray,maxTasks,numGoods);
+
+      // Matrix for the Boolean of the tasks.
+      Matrix<BoolVarArgs> robotTasksBool(robotTasksBoolArray,maxTasks,5);
+
+      // Matrix for the Boolean for the positions of the robot at start of the
+      // task.
+      Matrix<BoolVarArgs> robotPositionsStartBool(robotPositionsStartBoolArray,maxTasks,49);
+
+      // Matrix for the orientation of the robot at start of the task.
+      Matrix<BoolVarArgs> robotOrientationStartBool(robotOrientationStartBoolArray,maxTasks,4);
+
+
+
+
+      /// TASKS
+
+      // These are the five tasks:
+      //
+      // Task 0: Do nothing (only at the end)
+      // Task 1: Turning (Right or Left)
+      // Task 2: Moving (-1 to 6) Note that -1 is a Backward move
+      // Task 3: Pick up
+      // Task 4: Drop
+
+      // JobCost for the five tasks and the moving steps (-1 to 6): the
+      // duration of the task, taken from the calibration. Only the do
+      // nothing task costs nothing. The index is task * 8 + steps + 1,
+      // all tasks but moving tasks have 0 steps.
+      IntArgs jobCost(5*8);
+      for (int k = 0; k < 5*8; k++) {
+          jobCost[k] = 0;
+      }
+      for (int steps = -1; steps <= 6; steps++) {
+          jobCost[1*8 + steps + 1] = cal.turn;
+          jobCost[3*8 + steps + 1] = cal.pick;
+          jobCost[4*8 + steps + 1] = cal.drop;
+          if (steps == -1) {
+              jobCost[2*8 + steps + 1] = cal.backward;
+          } else if (steps > 0) {
+              jobCost[2*8 + steps + 1] = cal.forward(steps);
+          }
+      }
+
+      // Help Array for the difference per step. The index of the array
+      // represents the orientation of the robot.
+      // E.g. is the orientation north, then for the robot one step is adding
+      // 7 to the current position, like from position 14 to 21.
+      IntArgs jobMovingOrientation(5,  7, 1, -7, -1, 0);
+
+      // Help Array for the 16 Warehouse fields.
+      int warehouseFields [16] = {8,9,11,12,15,16,18,19,29,30,32,33,36,37,39,40};
+
+      // Help Array for the 12 finish warehouse places. Here are not included
+      // the four places at the start.
+      int finishWarehouseFields [12] = {11,12,18,19,29,30,32,33,36,37,39,40};
+
+      // Garage fields - there is no temperature and light sensor
+      int garageFields [4] = {8,9,15,16};
+
+      // Help Array for the 33 street fields.
+      int streetFields [33] = {0,1,2,3,4,5,6,7,10,13,14,17,20,21,22,23,24,25,26,27,28,31,34,35,38,41,42,43,44,45,46,47,48};
+
+
+
+
+      /// START CONSTRAINTS
+
+      // The start position and orientation of the robot and the starting
+      // positions of the goods are posted with the job (see postJob).
+
+      // The current good at the robot; -1 means that no good is at the robot;
+      // Otherwise 0 to numGoods-1
+      rel(*this, robotGoodsStart[0] == -1);
+
+      /// CONSTRAINTS FOR EACH TASK
+
+      for (int i = 0; i < maxTasks; i++) {
+
+          /// END - START CONSTRAINTS
+
+          if (i < maxTasks - 1) {
+
+            // End Position of task i is the start position of task i + 1
+            // This holds for the robot (and for the goods, see above).
+            rel(*this, robotPositionsEnd[i] == robotPositionsStart[i+1]);
+            rel(*this, robotOrientationEnd[i] == robotOrientationStart[i+1]);
+
+            // The good at the robot at the end of task i is the same good
+            // at the robot at task i + 1.
+            rel(*this, robotGoodsEnd[i] == robotGoodsStart[i+1]);
+
+          }
+
+          // Channel the robot Tasks to a Boolean for each Task.
+          channel(*this, robotTasksBool.col(i), robotTasks[i]);
+          // All Boolean Tasks must sum up to 1.
+          linear(*this, robotTasksBool.col(i), IRT_EQ, 1);
+
+          // Channel robot Positions.
+          channel(*this, robotPositionsStartBool.col(i), robotPositionsStart[i]);
+          // All Boolean Tasks must sum up to 1.
+          linear(*this, robotPositionsStartBool.col(i), IRT_EQ, 1);
+
+          // channel robot Orientation and they sum up to 1.
+          channel(*this, robotOrientationStartBool.col(i), robotOrientationStart[i]);
+          // All Boolean Tasks must sum up to 1.
+          linear(*this, robotOrientationStartBool.col(i), IRT_EQ, 1);
+
+
+
+
+          /// TASK 1: TURNING
+
+          // Help array: -1 Turn left; +1 Turn right.
+          int domainBool [2] = {-1, 1};
+
+          // Orientation at the start + the difference + 4 is the
+          // orientation for the robot at the end without modulo.
+          rel(*this, robotOrientationStart[i] + robotOrientDiff[i] + 4 == robotOrientMod[i]);
+
+          // Adding the modulo constraint for the orientation of the robot at
+          // the end.
+          mod(*this, robotOrientMod[i], IntVar(*this, 4, 4), robotOrientationEnd[i]);
+
+          // If the current task is a Turning Task (== Task 1), the difference
+          // of the robot orentation will be -1 or 1. Otherwise 0, since there
+          // is no other turnings in the other tasks.
+          ite(*this, robotTasksBool(i,1), IntVar(*this, IntSet(domainBool, 2)), IntVar(*this,0,0), robotOrientDiff[i]);
+
+          /*
+          // Uncomment this, if it should be not allowed to make two turns in
+          // a row, like a 180 degree movement.
+          //
+          // There will be no two turns in a row. We do not need a 180 or
+          // 270 degree turn.
+          if (i < maxTasks-1) {
+              rel(*this, robotTasksBool(i,1) + robotTasksBool(i+1,1) < 2);
+          }
+          */
+
+
+
+          /// TASK 2: MOVING
+
+          // The start position + the difference between start and end is the
+          // end position.
+          rel(*this, robotPositionsStart[i] + robotPositionsDiff[i] == robotPositionsEnd[i]);
+
+          // The difference is the number of steps (-1 to 6) * the difference
+          // for one step (that is dependent on the current orientation of the
+          // robot).
+          rel(*this, robotPositionsDiff[i] == robotPositionsDiffTemp[i] * robotMovingForward[i]);
+
+          // Help Array for the possible moving steps (everything from -1 to
+          // 6, without the 0).
+          int possibleMovingSteps [7] = {-1, 1, 2, 3, 4, 5, 6};
+
+          // If the current task is a moving task, then the number of steps will
+          // be a value from this help array.
+          ite(*this, robotTasksBool(i,2), IntVar(*this, IntSet(possibleMovingSteps, 7)), IntVar(*this, 0, 0), robotMovingForward[i]);
+
+          // Checking Moving Forward
+          IntVar definedRobotOrientation(*this, 0, 4);
+
+          // If the current task is a moving task, then the value of
+          // definedRobotOrientation is between 0 and 3, otherwise 4. this
+          // 4 is needed for the case that the current task is not a moving,
+          // because then the difference will be 0.
+          ite(*this, robotTasksBool(i,2), IntVar(*this, 0, 3), IntVar(*this, 4, 4), definedRobotOrientation);
+
+          // If the current task is a moving task, then the value of
+          // definedRobotOrientation is the same as the orientation of the
+          // robot from the start of the task.
+          ite(*this, robotTasksBool(i,2), robotOrientationStart[i], IntVar(*this, 4, 4), definedRobotOrientation);
+
+          // Finally, the difference for one step for the robot is the same
+          // as the value at the index of the current orientation of the
+          // robot from the help array jobMovingOrientation:
+          //    jobMovingOrientation(5,  7, 1, -7, -1, 0);
+          element(*this, jobMovingOrientation, definedRobotOrientation, robotPositionsDiffTemp[i]);
+
+          // If the current task is a backward moving, then the start of the
+          // task must be in one of the 16 warehouse places.
+          ite(*this, expr(*this, robotMovingForward[i] == IntVar(*this, -1, -1)), IntVar(*this, IntSet(warehouseFields,16)), IntVar(*this, 0, 48), robotPositionsStart[i]);
+
+          // If the current task is a moving, then the robot position at the
+          // start and at the end must be in one of the street fields, since
+          // the robot can not turn inside a warehouse field.
+          ite(*this, robotTasksBool(i,1), IntVar(*this, IntSet(streetFields,33)), IntVar(*this, 0, 48), robotPositionsStart[i]);
+          ite(*this, robotTasksBool(i,1), IntVar(*this, IntSet(streetFields,33)), IntVar(*this, 0, 48), robotPositionsEnd[i]);
+
+
+
+          // No two Movings in a row.
+          if (i < maxTasks-1) {
+              rel(*this, robotTasksBool(i,2) + robotTasksBool(i+1,2) < 2);
+          }
+
+
+          // Movement of the goods:
+          //
+          // By iterating over all goods, if the current task is a moving task
+          // and the current good at the robot is the current good in this
+          // iteration, then the end position of this current good in this
+          // task will be the same as the end position of the robot at this
+          // task. Otherwise, the good is not moving in this task, and then
+          // the end position at this task will be the same as the start
+          // position  of this good.
+          //
+          // With more than one robot, the good only follows the robot that
+          // carries it. That no other good moves is posted for all robots
+          // together (see postRobots).
+          for (int j=0; j < numGoods; j++) {
+            if (numRobots == 1) {
+              ite(*this, expr(*this, !(robotTasksBool(i,2) && (robotGoodsStart[i] == IntVar(*this, j, j)))), goodsPositionStart(i,j), robotPositionsEnd[i], goodsPositionEnd(i,j));
+            } else {
+              BoolVar carried = expr(*this, robotTasksBool(i,2) && (robotGoodsStart[i] == j));
+              rel(*this, goodsPositionEnd(i,j), IRT_EQ, robotPositionsEnd[i], Reify(carried, RM_IMP));
+              goodsCarried[(i*numGoods + j)*numRobots + r] = carried;
+            }
+          }
+
+
+
+
+          /// TASK 3: PICKING UP
+
+          // Help IntVars:
+          IntVar definedRobotGoodsEnd(*this, 0, numGoods - 1);
+          IntVar definedRobotPositionsEnd(*this, 0, 48);
+
+          // If the current task is a picking up task, then the robot must
+          // have no goods at the start of this task. Otherwise, the
+          // robot could have goods or not.
+          ite(*this, robotTasksBool(i,3), IntVar(*this,-1,-1), IntVar(*this,-1,numGoods-1), robotGoodsStart[i]);
+
+          // If the current task is a picking up task, then the good of the
+          // robot is stored in the help IntVar definedRobotGoodsEnd.
+          ite(*this, robotTasksBool(i,3), definedRobotGoodsEnd, IntVar(*this, -1, numGoods-1), robotGoodsEnd[i]);
+
+          // If the current task is a picking up task, then the end position
+          // of the robot is stored in the help IntVar definedRobotPositionsEnd.
+          ite(*this, robotTasksBool(i,3), definedRobotPositionsEnd, IntVar(*this, 0, 48), robotPositionsEnd[i]);
+
+          // Finally, we are searching with the element constraint for the
+          // number of the good that is at the same position as the robot
+          // at the moment.
+          element(*this, goodsPositionStart.col(i), definedRobotGoodsEnd, definedRobotPositionsEnd);
+
+
+
+
+          /// TASK 4: DROPPING
+
+          // If the current task is a dropping task, then the robot must
+          // have no good at the end. Otherwise, it can be anything.
+          ite(*this, robotTasksBool(i,4), IntVar(*this,-1,-1), IntVar(*this,-1,numGoods-1), robotGoodsEnd[i]);
+
+          // If the current task is a dropping task, then the robot must have
+          // a good at the start of the task. Otherwise, it can be anything.
+          ite(*this, robotTasksBool(i,4), IntVar(*this,0,numGoods-1), IntVar(*this,-1,numGoods-1), robotGoodsStart[i]);
+
+
+
+
+          /// TASK 3 OR 4: PICKING OR DROPPING
+
+          // If the current task is not a picking or a dropping task, then
+          // the good at the robot will be the same before and after the task.
+          ite(*this, expr(*this, robotTasksBool(i,3) || robotTasksBool(i,4)), IntVar(*this, -1, numGoods-1), robotGoodsStart[i], robotGoodsEnd[i]);
+
+
+          // Before a picking or a dropping there must be a forward 1 move.
+          if (i > 1) {
+            ite(*this, robotTasksBool(i,4), IntVar(*this, 2, 2), IntVar(*this, 0, 4), robotTasks[i-1]);
+            ite(*this, robotTasksBool(i,4), IntVar(*this, 1, 1), IntVar(*this, -1, 6), robotMovingForward[i-1]);
+
+            ite(*this, robotTasksBool(i,3), IntVar(*this, 2, 2), IntVar(*this, 0, 4), robotTasks[i-1]);
+            ite(*this, robotTasksBool(i,3), IntVar(*this, 1, 1), IntVar(*this, -1, 6), robotMovingForward[i-1]);
+          }
+
+          // After a picking or a dropping there must be a backward movement.
+          if (i < maxTasks-1) {
+            ite(*this, robotTasksBool(i,4), IntVar(*this, 2, 2),  IntVar(*this, 0, 4), robotTasks[i+1]);
+            ite(*this, robotTasksBool(i,4), IntVar(*this, -1, -1), IntVar(*this, -1, 6), robotMovingForward[i+1]);
+
+            ite(*this, robotTasksBool(i,3), IntVar(*this, 2, 2),  IntVar(*this, 0, 4), robotTasks[i+1]);
+            ite(*this, robotTasksBool(i,3), IntVar(*this, -1, -1), IntVar(*this, -1, 6), robotMovingForward[i+1]);
+          } else {
+
+            // Last job can not be a picking or a dropping.
+            rel(*this, robotTasks[i] != IntVar(*this, 4,4));
+            rel(*this, robotTasksBool(i,4) == false);
+
+            rel(*this, robotTasks[i] != IntVar(*this, 3,3));
+            rel(*this, robotTasksBool(i,3) == false);
+          }
+
+          // Picking up and dropping only in the Warehouse fields.
+          ite(*this, robotTasksBool(i,3), IntVar(*this, IntSet(warehouseFields,16)), IntVar(*this, 0, 48), robotPositionsStart[i]);
+          ite(*this, robotTasksBool(i,3), IntVar(*this, IntSet(warehouseFields,16)), IntVar(*this, 0, 48), robotPositionsEnd[i]);
+
+          ite(*this, robotTasksBool(i,4), IntVar(*this, IntSet(warehouseFields,16)), IntVar(*this, 0, 48), robotPositionsStart[i]);
+          ite(*this, robotTasksBool(i,4), IntVar(*this, IntSet(warehouseFields,16)), IntVar(*this, 0, 48), robotPositionsEnd[i]);
+
+          // No two picking or dropping in a row.
+          if (i < maxTasks-1) {
+              rel(*this, robotTasksBool(i,3) + robotTasksBool(i,4) + robotTasksBool(i+1,3) + robotTasksBool(i+1,4) < 2 );
+          }
+
+
+
+          /// NOT ALLOWED MOVEMENTS
+
+          // If the orientation from the robot is to North = 0.
+          ite(*this, expr(*this,robotPositionsStartBool(i,0) && robotOrientationStartBool(i,0)), IntVar(*this, 0,6), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,3) && robotOrientationStartBool(i,0)), IntVar(*this, 0,6), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,6) && robotOrientationStartBool(i,0)), IntVar(*this, 0,6), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,1) && robotOrientationStartBool(i,0)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,2) && robotOrientationStartBool(i,0)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,4) && robotOrientationStartBool(i,0)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,5) && robotOrientationStartBool(i,0)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,7) && robotOrientationStartBool(i,0)), IntVar(*this, -1,5), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,10) && robotOrientationStartBool(i,0)), IntVar(*this, -1,5), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,13) && robotOrientationStartBool(i,0)), IntVar(*this, -1,5), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,8) && robotOrientationStartBool(i,0)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,9) && robotOrientationStartBool(i,0)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,11) && robotOrientationStartBool(i,0)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,12) && robotOrientationStartBool(i,0)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,14) && robotOrientationStartBool(i,0)), IntVar(*this, -1,4), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,17) && robotOrientationStartBool(i,0)), IntVar(*this, -1,4), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,20) && robotOrientationStartBool(i,0)), IntVar(*this, -1,4), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,15) && robotOrientationStartBool(i,0)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,16) && robotOrientationStartBool(i,0)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,18) && robotOrientationStartBool(i,0)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,19) && robotOrientationStartBool(i,0)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,21) && robotOrientationStartBool(i,0)), IntVar(*this, -1,3), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,24) && robotOrientationStartBool(i,0)), IntVar(*this, -1,3), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,27) && robotOrientationStartBool(i,0)), IntVar(*this, -1,3), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,22) && robotOrientationStartBool(i,0)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,23) && robotOrientationStartBool(i,0)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,25) && robotOrientationStartBool(i,0)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,26) && robotOrientationStartBool(i,0)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,28) && robotOrientationStartBool(i,0)), IntVar(*this, -1,2), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,31) && robotOrientationStartBool(i,0)), IntVar(*this, -1,2), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,34) && robotOrientationStartBool(i,0)), IntVar(*this, -1,2), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,29) && robotOrientationStartBool(i,0)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,30) && robotOrientationStartBool(i,0)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,32) && robotOrientationStartBool(i,0)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,33) && robotOrientationStartBool(i,0)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,35) && robotOrientationStartBool(i,0)), IntVar(*this, -1,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,38) && robotOrientationStartBool(i,0)), IntVar(*this, -1,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,41) && robotOrientationStartBool(i,0)), IntVar(*this, -1,1), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,36) && robotOrientationStartBool(i,0)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,37) && robotOrientationStartBool(i,0)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,39) && robotOrientationStartBool(i,0)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,40) && robotOrientationStartBool(i,0)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,42) && robotOrientationStartBool(i,0)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,45) && robotOrientationStartBool(i,0)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,48) && robotOrientationStartBool(i,0)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,43) && robotOrientationStartBool(i,0)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,44) && robotOrientationStartBool(i,0)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,46) && robotOrientationStartBool(i,0)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,47) && robotOrientationStartBool(i,0)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+
+          // If the orientation from the robot is to East = 1.
+          ite(*this, expr(*this,robotPositionsStartBool(i,0) && robotOrientationStartBool(i,1)), IntVar(*this, 0,6), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,21) && robotOrientationStartBool(i,1)), IntVar(*this, 0,6), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,42) && robotOrientationStartBool(i,1)), IntVar(*this, 0,6), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,7) && robotOrientationStartBool(i,1)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,14) && robotOrientationStartBool(i,1)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,28) && robotOrientationStartBool(i,1)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,35) && robotOrientationStartBool(i,1)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,1) && robotOrientationStartBool(i,1)), IntVar(*this, -1,5), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,22) && robotOrientationStartBool(i,1)), IntVar(*this, -1,5), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,43) && robotOrientationStartBool(i,1)), IntVar(*this, -1,5), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,8) && robotOrientationStartBool(i,1)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,15) && robotOrientationStartBool(i,1)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,29) && robotOrientationStartBool(i,1)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,36) && robotOrientationStartBool(i,1)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,2) && robotOrientationStartBool(i,1)), IntVar(*this, -1,4), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,23) && robotOrientationStartBool(i,1)), IntVar(*this, -1,4), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,44) && robotOrientationStartBool(i,1)), IntVar(*this, -1,4), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,9) && robotOrientationStartBool(i,1)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,16) && robotOrientationStartBool(i,1)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,30) && robotOrientationStartBool(i,1)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,37) && robotOrientationStartBool(i,1)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,3) && robotOrientationStartBool(i,1)), IntVar(*this, -1,3), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,24) && robotOrientationStartBool(i,1)), IntVar(*this, -1,3), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,45) && robotOrientationStartBool(i,1)), IntVar(*this, -1,3), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,10) && robotOrientationStartBool(i,1)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,17) && robotOrientationStartBool(i,1)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,31) && robotOrientationStartBool(i,1)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,38) && robotOrientationStartBool(i,1)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,4) && robotOrientationStartBool(i,1)), IntVar(*this, -1,2), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,25) && robotOrientationStartBool(i,1)), IntVar(*this, -1,2), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,46) && robotOrientationStartBool(i,1)), IntVar(*this, -1,2), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,11) && robotOrientationStartBool(i,1)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,18) && robotOrientationStartBool(i,1)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,32) && robotOrientationStartBool(i,1)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,39) && robotOrientationStartBool(i,1)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,5) && robotOrientationStartBool(i,1)), IntVar(*this, -1,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,26) && robotOrientationStartBool(i,1)), IntVar(*this, -1,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,47) && robotOrientationStartBool(i,1)), IntVar(*this, -1,1), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,12) && robotOrientationStartBool(i,1)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,19) && robotOrientationStartBool(i,1)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,33) && robotOrientationStartBool(i,1)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,40) && robotOrientationStartBool(i,1)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,6) && robotOrientationStartBool(i,1)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,27) && robotOrientationStartBool(i,1)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,48) && robotOrientationStartBool(i,1)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,13) && robotOrientationStartBool(i,1)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,20) && robotOrientationStartBool(i,1)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,34) && robotOrientationStartBool(i,1)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,41) && robotOrientationStartBool(i,1)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+
+          // If the orientation from the robot is to South = 2.
+          ite(*this, expr(*this,robotPositionsStartBool(i,42) && robotOrientationStartBool(i,2)), IntVar(*this, 0,6), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,45) && robotOrientationStartBool(i,2)), IntVar(*this, 0,6), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,48) && robotOrientationStartBool(i,2)), IntVar(*this, 0,6), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,43) && robotOrientationStartBool(i,2)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,44) && robotOrientationStartBool(i,2)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,46) && robotOrientationStartBool(i,2)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,47) && robotOrientationStartBool(i,2)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,35) && robotOrientationStartBool(i,2)), IntVar(*this, -1,5), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,38) && robotOrientationStartBool(i,2)), IntVar(*this, -1,5), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,41) && robotOrientationStartBool(i,2)), IntVar(*this, -1,5), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,36) && robotOrientationStartBool(i,2)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,37) && robotOrientationStartBool(i,2)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,39) && robotOrientationStartBool(i,2)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,40) && robotOrientationStartBool(i,2)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,28) && robotOrientationStartBool(i,2)), IntVar(*this, -1,4), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,31) && robotOrientationStartBool(i,2)), IntVar(*this, -1,4), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,34) && robotOrientationStartBool(i,2)), IntVar(*this, -1,4), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,29) && robotOrientationStartBool(i,2)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,30) && robotOrientationStartBool(i,2)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,32) && robotOrientationStartBool(i,2)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,33) && robotOrientationStartBool(i,2)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,21) && robotOrientationStartBool(i,2)), IntVar(*this, -1,3), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,24) && robotOrientationStartBool(i,2)), IntVar(*this, -1,3), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,27) && robotOrientationStartBool(i,2)), IntVar(*this, -1,3), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,22) && robotOrientationStartBool(i,2)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,23) && robotOrientationStartBool(i,2)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,25) && robotOrientationStartBool(i,2)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,26) && robotOrientationStartBool(i,2)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,14) && robotOrientationStartBool(i,2)), IntVar(*this, -1,2), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,17) && robotOrientationStartBool(i,2)), IntVar(*this, -1,2), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,20) && robotOrientationStartBool(i,2)), IntVar(*this, -1,2), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,15) && robotOrientationStartBool(i,2)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,16) && robotOrientationStartBool(i,2)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,18) && robotOrientationStartBool(i,2)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,19) && robotOrientationStartBool(i,2)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,7) && robotOrientationStartBool(i,2)), IntVar(*this, -1,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,10) && robotOrientationStartBool(i,2)), IntVar(*this, -1,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,13) && robotOrientationStartBool(i,2)), IntVar(*this, -1,1), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,8) && robotOrientationStartBool(i,2)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,9) && robotOrientationStartBool(i,2)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,11) && robotOrientationStartBool(i,2)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,12) && robotOrientationStartBool(i,2)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,0) && robotOrientationStartBool(i,2)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,3) && robotOrientationStartBool(i,2)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,6) && robotOrientationStartBool(i,2)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,1) && robotOrientationStartBool(i,2)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,2) && robotOrientationStartBool(i,2)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,4) && robotOrientationStartBool(i,2)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,5) && robotOrientationStartBool(i,2)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+
+          // If the orientation from the robot is to West = 3.
+          ite(*this, expr(*this,robotPositionsStartBool(i,6) && robotOrientationStartBool(i,3)), IntVar(*this, 0,6), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,27) && robotOrientationStartBool(i,3)), IntVar(*this, 0,6), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,48) && robotOrientationStartBool(i,3)), IntVar(*this, 0,6), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,13) && robotOrientationStartBool(i,3)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,20) && robotOrientationStartBool(i,3)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,34) && robotOrientationStartBool(i,3)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,41) && robotOrientationStartBool(i,3)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,5) && robotOrientationStartBool(i,3)), IntVar(*this, -1,5), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,26) && robotOrientationStartBool(i,3)), IntVar(*this, -1,5), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,47) && robotOrientationStartBool(i,3)), IntVar(*this, -1,5), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,12) && robotOrientationStartBool(i,3)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,19) && robotOrientationStartBool(i,3)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,33) && robotOrientationStartBool(i,3)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,40) && robotOrientationStartBool(i,3)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,4) && robotOrientationStartBool(i,3)), IntVar(*this, -1,4), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,25) && robotOrientationStartBool(i,3)), IntVar(*this, -1,4), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,46) && robotOrientationStartBool(i,3)), IntVar(*this, -1,4), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,11) && robotOrientationStartBool(i,3)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,18) && robotOrientationStartBool(i,3)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,32) && robotOrientationStartBool(i,3)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,39) && robotOrientationStartBool(i,3)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,3) && robotOrientationStartBool(i,3)), IntVar(*this, -1,3), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,24) && robotOrientationStartBool(i,3)), IntVar(*this, -1,3), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,45) && robotOrientationStartBool(i,3)), IntVar(*this, -1,3), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,10) && robotOrientationStartBool(i,3)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,17) && robotOrientationStartBool(i,3)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,31) && robotOrientationStartBool(i,3)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,38) && robotOrientationStartBool(i,3)), IntVar(*this, 0,1), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,2) && robotOrientationStartBool(i,3)), IntVar(*this, -1,2), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,23) && robotOrientationStartBool(i,3)), IntVar(*this, -1,2), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,44) && robotOrientationStartBool(i,3)), IntVar(*this, -1,2), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,9) && robotOrientationStartBool(i,3)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,16) && robotOrientationStartBool(i,3)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,30) && robotOrientationStartBool(i,3)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,37) && robotOrientationStartBool(i,3)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,1) && robotOrientationStartBool(i,3)), IntVar(*this, -1,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,22) && robotOrientationStartBool(i,3)), IntVar(*this, -1,1), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,43) && robotOrientationStartBool(i,3)), IntVar(*this, -1,1), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,8) && robotOrientationStartBool(i,3)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,15) && robotOrientationStartBool(i,3)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,29) && robotOrientationStartBool(i,3)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,36) && robotOrientationStartBool(i,3)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,0) && robotOrientationStartBool(i,3)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,21) && robotOrientationStartBool(i,3)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,42) && robotOrientationStartBool(i,3)), IntVar(*this, -1,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+          ite(*this, expr(*this,robotPositionsStartBool(i,7) && robotOrientationStartBool(i,3)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,14) && robotOrientationStartBool(i,3)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,28) && robotOrientationStartBool(i,3)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+          ite(*this, expr(*this,robotPositionsStartBool(i,35) && robotOrientationStartBool(i,3)), IntVar(*this, 0,0), IntVar(*this,-1,6), robotMovingForward[i]);
+
+
+
+          // SYMMETRIES
+
+          // Null Jobs at the end (for each robot).
+          if (i < maxTasks-1) {
+           ite(*this, robotTasksBool(i,0), IntVar(*this, 0, 0), IntVar(*this, 0, 4), robotTasks[i+1]);
+          }
+
+      }
+
+
+        /// END CONSTRAINTS
+
+        // The robot should have no good at the end.
+        rel(*this, robotGoodsEnd[maxTasks-1] == -1);
+
+
+      /// COST
+
+      /// Mapping Cost of a job and its moving steps to each task of the
+      /// robot
+      for (int i = 0; i < maxTasks; i++) {
+          element(*this, jobCost, expr(*this, robotTasks[i]*8 + robotMovingForward[i] + 1), robotTasksCost[i]);
+      }
+
+  }
+
+  /// Posts the constraints between the robots, if there is more than one
+  /// robot. The tasks with the same index are one common step of all
+  /// robots. The robots only execute the steps together, because they wait
+  /// for each other at the SYNC instructions (see robotInstructions).
+  ///
+  ///  - A good only moves, if a robot carries it in a moving task.
+  ///  - In each step, each field is occupied by at most one robot. A robot
+  ///    occupies all fields from its start to its end position of the
+  ///    step, so within a step two robots are never planned in the same
+  ///    field and never pass through each other. Between the steps this
+  ///    holds only as far as the robots keep to the SYNC points.
+  ///
+  /// Returns the makespan: the duration of the longest robot.
+  IntVar postRobots(const BoolVarArgs& goodsCarried) {
+
+      Matrix<IntVarArray> goodsPositionStart(goodsPositionStartArray,maxTasks,numGoods);
+      Matrix<IntVarArray> goodsPositionEnd(goodsPositionEndArray,maxTasks,numGoods);
+
+      for (int i = 0; i < maxTasks; i++) {
+
+          // A good that no robot carries stays where it is.
+          for (int j = 0; j < numGoods; j++) {
+              BoolVarArgs carried(numRobots);
+              for (int r = 0; r < numRobots; r++) {
+                  carried[r] = goodsCarried[(i*numGoods + j)*numRobots + r];
+              }
+              rel(*this, (goodsPositionEnd(i,j) == goodsPositionStart(i,j)) || (sum(carried) >= 1));
+          }
+
+          // Rows and columns of the robots at the start and at the end of
+          // the step. A robot moves only straight, so it is in one row or
+          // in one column during the step.
+          IntVarArgs rowStart(numRobots), colStart(numRobots);
+          IntVarArgs rowEnd(numRobots), colEnd(numRobots);
+          for (int r = 0; r < numRobots; r++) {
+              rowStart[r] = expr(*this, robotPositionsStart[r*maxTasks+i] / 7);
+              colStart[r] = expr(*this, robotPositionsStart[r*maxTasks+i] % 7);
+              rowEnd[r] = expr(*this, robotPositionsEnd[r*maxTasks+i] / 7);
+              colEnd[r] = expr(*this, robotPositionsEnd[r*maxTasks+i] % 7);
+          }
+
+          for (int pos = 0; pos < 49; pos++) {
+              int row = pos / 7;
+              int col = pos % 7;
+              BoolVarArgs occupied(numRobots);
+              for (int r = 0; r < numRobots; r++) {
+                  occupied[r] = expr(*this,
+                    (rowStart[r] == row && rowEnd[r] == row
+                     && min(colStart[r], colEnd[r]) <= col && max(colStart[r], colEnd[r]) >= col)
+                    || (colStart[r] == col && colEnd[r] == col
+                     && min(rowStart[r], rowEnd[r]) <= row && max(rowStart[r], rowEnd[r]) >= row));
+              }
+              linear(*this, occupied, IRT_LQ, 1);
+          }
+      }
+
+      // The duration of a robot is the cost of its tasks (the null tasks at
+      // the end cost nothing).
+      IntVarArgs robotDuration(numRobots);
+      for (int r = 0; r < numRobots; r++) {
+          robotDuration[r] = expr(*this, sum(robotSlice<IntVarArgs>(robotTasksCost, r, maxTasks)));
+      }
+      IntVar makespan(*this, 0, robotCost.max());
+      max(*this, robotDuration, makespan);
+      return makespan;
+  }
+
+
+
+
+  /// Posts the constraints of the job on a clone of the root space of the
+  /// layout: the start of the robot and the goods, the number of pick up
+  /// and drop pairs, the end constraints of the jobs and the penalty cost.
+  ///
+  /// All other constraints of the constructor only depend on the layout
+  /// (the number of tasks and goods), so the root space can be built and
+  /// propagated once and cloned for every job.
+  void postJob(const WarehouseSnapshot& s, const WarehouseJob& job) {
+
+      // Setting up the two Matrizes for the positions of the goods at the
+      // start and at the end of the task.
+      Matrix<IntVarArray> goodsPositionStart(goodsPositionStartArray,maxTasks,numGoods);
+      Matrix<IntVarArray> goodsPositionEnd(goodsPositionEndArray,maxTasks,numGoods);
+
+      /// START CONSTRAINTS
+
+      // Start position and orientation of the robots
+      for (int r = 0; r < numRobots; r++) {
+          rel(*this, robotPositionsStart[r*maxTasks] == s.robots[r].position);
+          rel(*this, robotOrientationStart[r*maxTasks] == s.robots[r].orientation);
+      }
+      // The starting position from the goods. The added good starts at
+      // one of the free inbound docks, the planner chooses the dock.
+      for (int j = 0; j < numGoods; j++) {
+          if (job.addGood && j == numGoods-1) {
+              dom(*this, goodsPositionStart(0,j), IntSet(&job.addDocks[0], job.addDocks.size()));
+          } else {
+              rel(*this, goodsPositionStart(0,j) == job.goods[j].position);
+          }
+      }
+
+
+
+      // OVERALL CONSTRAINTS
+
+      // Only one picking up process in the complete program for a single
+      // job, since it is restricted to 16. A batch of jobs allows one
+      // picking up process for each job. This holds for all robots
+      // together.
+      BoolVarArgs robotPicks;
+      BoolVarArgs robotDrops;
+      for (int r = 0; r < numRobots; r++) {
+          Matrix<BoolVarArgs> robotTasksBool(robotSlice<BoolVarArgs>(robotTasksBoolArray, r, maxTasks*5),maxTasks,5);
+          robotPicks << robotTasksBool.row(3);
+          robotDrops << robotTasksBool.row(4);
+      }
+      linear(*this, robotPicks, IRT_LQ, job.numPickDrops);
+
+      // The same holds for the dropping processes.
+      linear(*this, robotDrops, IRT_LQ, job.numPickDrops);
+
+
+      /// END CONSTRAINTS
+
+      // Finally, we have to specify constraints about the jobs that are
+      // read from stdin. For a batch of jobs, all constraints of the
+      // jobs hold together after the final task.
+      if (job.moving) {
+          // If the job task is a moving task, then we have to specify the
+          // end position of the moving robot.
+          rel(*this, robotPositionsEnd[job.movingRobot*maxTasks+maxTasks-1] == job.movingPos);
+      }
+      if (!job.placeGoodNumber.empty()) {
+          // If the job is a task that we have to replace a good,
+          // then we can specify the end position of this good after the final task:
+          for (unsigned int k = 0; k < job.placeGoodNumber.size(); k++) {
+              rel(*this, goodsPositionEnd(maxTasks-1,job.placeGoodNumber[k]) == job.placeGoodToPos[k]);
+          }
+      }
+      if (job.addGood) {
+          // If the job was an adding task for a good, then will specify
+          // that this good shouldn’t be placed at a dock after the final
+          // tasks, since we want to move the current good from the
+          // inbound dock and we also want that the new good shouldn’t be
+          // at the end at an outbound dock, since we added this good to
+          // the Warehouse:
+          for (unsigned int k = 0; k < s.inboundDocks.size(); k++) {
+              rel(*this, goodsPositionEnd(maxTasks-1,numGoods-1) != s.inboundDocks[k]);
+          }
+          for (unsigned int k = 0; k < s.outboundDocks.size(); k++) {
+              rel(*this, goodsPositionEnd(maxTasks-1,numGoods-1) != s.outboundDocks[k]);
+          }
+      }
+      if (job.dropGood) {
+          // If the job is a dropping task for a good, then we will specify
+          // that this good has to be placed at one of the outbound docks
+          // after the final task. The planner chooses the cheapest dock.
+          dom(*this, goodsPositionEnd(maxTasks-1,job.dropGoodNumber),
+              IntSet(&s.outboundDocks[0], s.outboundDocks.size()));
+      }
+
+
+      /// COST
+
+      /// Adding Penalty Cost to the cost function.
+      /// For every good that doesn't fit the temperature and the light
+      /// constraint, we add a penalty to the cost function. We add also
+      /// the penalty, when the good is placed in one of the garage places,
+      /// because there are no temperature and light sensors. The fitting
+      /// places of all goods are taken from one fit matrix, so a single
+      /// reified domain constraint per good is enough.
+      FitMatrix fit(s, job.goods);
+      for (int i = 0; i < numGoods; i++) {
+          vector<int> penalized = fit.unfit(i);
+          penalized.insert(penalized.end(), s.garagePosition.begin(), s.garagePosition.end());
+          if (penalized.empty()) {
+              rel(*this, goodsPenaltyCost[i] == 0);
+              continue;
+          }
+          BoolVar goodPenalized(*this, 0, 1);
+          dom(*this, goodsPositionEnd(maxTasks-1,i),
+              IntSet(&penalized[0], penalized.size()), goodPenalized);
+          rel(*this, goodsPenaltyCost[i] == penalty * goodPenalized);
+      }
+
+
+
+      /// linear all RobotTaskCost to the complete cost.
+      linear(*this, goodsPenaltyCost, IRT_EQ, penaltyCost);
+
+  }
+
+
+
+
+  /// Constructor for cloning \a s
+  Warehouse(bool share, Warehouse& s) : IntMinimizeSpace(share,s),
+  maxTasks(s.maxTasks), numGoods(s.numGoods), numRobots(s.numRobots),
+  penalty(s.penalty) {
+    robotTasks.update(*this, share, s.robotTasks);
+    robotTasksBoolArray.update(*this, share, s.robotTasksBoolArray);
+    robotTasksCost.update(*this, share, s.robotTasksCost);
+    robotCost.update(*this, share, s.robotCost);
+    robotPositionsStart.update(*this, share, s.robotPositionsStart);
+    robotPositionsStartBoolArray.update(*this, share, s.robotPositionsStartBoolArray);
+    robotPositionsEnd.update(*this, share, s.robotPositionsEnd);
+    robotPositionsDiff.update(*this, share, s.robotPositionsDiff);
+    robotPositionsDiffTemp.update(*this, share, s.robotPositionsDiffTemp);
+    robotMovingForward.update(*this, share, s.robotMovingForward);
+    robotOrientationStart.update(*this, share, s.robotOrientationStart);
+    robotOrientationStartBoolArray.update(*this, share, s.robotOrientationStartBoolArray);
+    robotOrientationEnd.update(*this, share, s.robotOrientationEnd);
+    robotOrientDiff.update(*this, share, s.robotOrientDiff);
+    robotOrientMod.update(*this, share, s.robotOrientMod);
+    robotGoodsStart.update(*this, share, s.robotGoodsStart);
+    robotGoodsEnd.update(*this, share, s.robotGoodsEnd);
+    goodsPositionStartArray.update(*this, share, s.goodsPositionStartArray);
+    goodsPositionEndArray.update(*this, share, s.goodsPositionEndArray);
+    goodsPenaltyCost.update(*this, share, s.goodsPenaltyCost);
+    penaltyCost.update(*this, share, s.penaltyCost);
+    c.update(*this, share, s.c);
+  }
+  /// Copy during cloning
+  virtual Space*
+  copy(bool share) {
+    return new Warehouse(share,*this);
+  }
+  virtual IntVar cost(void) const{
+    return c;
+  }
+
+  /// Instructions of the robot \a r. \a backwardBefore tells, if the last
+  /// movement of the robot before this plan was a backward movement, and
+  /// \a backwardAfter returns the last movement after this plan.
+  ///
+  /// With several robots, each instruction is preceded by SYNC,t; with the
+  /// index t of the first task it covers, and SYNC,maxTasks; ends the
+  /// instructions. At SYNC,t the robot waits, until all robots have
+  /// reached a SYNC of at least t (see the web server), so the robots
+  /// execute the steps of the model together.
+  ///
+  /// Throws std::runtime_error, if a task of the solution cannot be
+  /// translated into an instruction.
+  string
+  robotInstructions(int r, bool backwardBefore, bool& backwardAfter) const {
+    string instructions = "";
+
+    // Save the current task and the previous task for some robot constraints.
+    // The robot should not get the instruction forward 1 and backward 1, when
+    // there is a picking up or a dropping task in the middle. This will be
+    // at the output only one task.
+    string temp = "";
+    string tempPrevious = "";
+    bool printPrevious = false;
+    bool printCurrent = false;
+    bool afterBackward = backwardBefore;
+    // Index of the first task of the current and the previous instruction.
+    int tempStart = 0;
+    int tempPreviousStart = 0;
+
+    for (int t = 0; t < maxTasks; t++) {
+
+        // Index of the task of the robot
+        int i = r*maxTasks + t;
+
+        // Copy old current task to the previous task.
+        tempPrevious = temp;
+        tempPreviousStart = tempStart;
+        tempStart = t;
+
+        // If the current task is a turning task, then the previous task and
+        // the current task should be printed.
+        if (robotTasks[i].val() == 1) {
+          temp = "TURN,";
+          // Checking After Backward or not
+          if (afterBackward) {
+              temp += "2,";
+          } else {
+              temp += "1,";
+          }
+          // Checking if left or right
+          if (robotOrientDiff[i].val() == -1) {
+              temp += "LEFT";
+          } else if (robotOrientDiff[i].val() == 1) {
+              temp += "RIGHT";
+          } else {
+            stringstream error;
+            error << "robot " << r << " turns without a direction at task " << t;
+            throw runtime_error(error.str());
+          }
+          temp += ";";
+          printPrevious = printCurrent && true;
+          printCurrent = true;
+          afterBackward = false;
+
+        }
+        else if (robotTasks[i].val() == 2) {
+
+          // If the current task is a backward task, then this task should not
+          // be printed, but the previous task can be printed
+          if (robotMovingForward[i].val() == -1) {
+            temp = "BACKWARD,1;";
+            printPrevious = printCurrent && true;
+            printCurrent = false;
+            afterBackward = true;
+          } else {
+
+            // If the current task is a normal forward task, then the current
+            // and the previous task can be printed. The number of forward
+            // steps (1 to 6) is printed, too.
+            stringstream stringStreamForward;
+            stringStreamForward << robotMovingForward[i].val();
+            temp = "FORWARD," + stringStreamForward.str() + ",";
+            // Adding which Sensors
+            if (robotOrientationStart[i].val() == 0 || robotOrientationStart[i].val() == 1) {
+                temp += "0"; // Right sensor
+            } else if (robotOrientationStart[i].val() == 2 || robotOrientationStart[i].val() == 3) {
+                temp += "1"; // Left sensor
+            } else {
+                stringstream error;
+                error << "robot " << r << " moves without an orientation at task " << t;
+                throw runtime_error(error.str());
+            }
+            temp += ";";
+            printPrevious = printCurrent && true;
+            printCurrent = true;
+            afterBackward = false;
+          }
+        }
+        // If the current task is a picking task, then this task can be printed,
+        // but not the previous forward 1 task.
+        else if (robotTasks[i].val() == 3) {
+          temp = "PICK,1;";
+          if (printCurrent) {
+              tempStart = tempPreviousStart;
+          }
+          printPrevious = printCurrent && false;
+          printCurrent = true;
+          afterBackward = false;
+        }
+        // If the current task is a dropping task, then this task can be
+        // printed, but not the previous forward 1 task.
+        else if (robotTasks[i].val() == 4) {
+          temp = "DROP,1;";
+          if (printCurrent) {
+              tempStart = tempPreviousStart;
+          }
+          printPrevious = printCurrent && false;
+          printCurrent = true;
+          afterBackward = false;
+        }
+        // Otherwise: Dont print only the previous one, but not the current
+        // task.
+        else {
+          temp = "";
+          printPrevious = printCurrent && true;
+          printCurrent = false;
+          if (robotTasks[i].val() != 0) {
+              afterBackward = false;
+          }
+        }
+        if (printPrevious) {
+          instructions += sync(tempPreviousStart) + tempPrevious;
+        }
+    }
+    // Print at the end also the current task, if the current task should be
+    // printed.
+    if (printCurrent) {
+      instructions += sync(tempStart) + temp;
+    }
+    instructions += sync(maxTasks);
+
+    // Save for further runnings, if the last step was a backward step,
+    // because then the robot must turn the wheel backwards.
+    backwardAfter = afterBackward;
+
+    return instructions;
+  }
+
+  /// Synchronization point before the task \a t, if there are several
+  /// robots.
+  string
+  sync(int t) const {
+    if (numRobots < 2) {
+        return "";
+    }
+    stringstream stringStreamSync;
+    stringStreamSync << "SYNC," << t << ";";
+    return stringStreamSync.str();
+  }
+
+  /// Plan of a solution for the robots of the snapshot \a s and the job
+  /// \a job.
+  WarehousePlan
+  plan(const WarehouseSnapshot& s, const WarehouseJob& job) const {
+    WarehousePlan p;
+    p.found = true;
+
+    p.instructions = "INSTRUCTIONS:";
+    for (int r = 0; r < numRobots; r++) {
+        WarehouseRobot robot;
+        if (r > 0) {
+            p.instructions += "|";
+        }
+        p.instructions += robotInstructions(r, s.robots[r].backward, robot.backward);
+
+        // Save also the final position and orientation of the robot.
+        robot.position = robotPositionsEnd[r*maxTasks+maxTasks-1].val();
+        robot.orientation = robotOrientationEnd[r*maxTasks+maxTasks-1].val();
+        p.robots.push_back(robot);
+    }
+
+    // Saving the end positions of the goods for writing to the JSON file later.
+    Matrix<IntVarArray> goodsPositionEnd(goodsPositionEndArray,maxTasks,numGoods);
+    for (int j = 0; j < numGoods; j++) {
+        p.goodsEndPositions.push_back(goodsPositionEnd(maxTasks-1,j).val());
+    }
+
+    // The inbound dock of the added good.
+    if (job.addGood) {
+        Matrix<IntVarArray> goodsPositionStart(goodsPositionStartArray,maxTasks,numGoods);
+        p.addDock = goodsPositionStart(0,numGoods-1).val();
+    }
+
+    // Saving the cost of the robot and the penalty cost of the goods.
+    p.robotCost = robotCost.val();
+    p.penaltyCost = penaltyCost.val();
+
+    return p;
+  }
+
+};
+
+
+
+
+/* -------------------------------
+ *  SNAPSHOT, JOB AND PLAN
+ *  -------------------------------
+ */
+
+WarehousePlan::WarehousePlan(void)
+  : found(false), complete(false), cancelled(false), addDock(-1),
+    robotCost(0), penaltyCost(0) {}
+
+Calibration::Calibration(void)
+  : unit(1), turn(1), backward(1), pick(1), drop(1), forwardBase(1),
+    forwardPerCell(0), penalty(100) {}
+
+/// Converts \a ms milliseconds into cost units. Each instruction costs at
+/// least one unit.
+static int calibrationUnits(const Json::Value& ms, int unit, int defaultUnits) {
+    if (!ms.isNumeric()) {
+        return defaultUnits;
+    }
+    return std::max(1, (int) ((ms.asDouble() + unit / 2) / unit));
+}
+
+/// The durations are given in milliseconds and rounded to the unit
+/// (default 100 ms), which keeps the domains of the cost small:
+///
+///   {"unit":100,"turn":1800,"backward":1500,"pick":4200,"drop":3900,
+///    "forward":{"base":400,"perCell":900},"penalty":180000}
+///
+/// Without a penalty, a misplaced good costs as much as 100 turns.
+Calibration
+Calibration::read(const string& file) {
+    Calibration c;
+    Json::Value root;
+    std::ifstream config_calibration(file.c_str());
+    Json::Reader reader;
+    if (!config_calibration.good() || !reader.parse(config_calibration, root)
+        || !root.isObject()) {
+        return c;
+    }
+    c.unit = std::max(1, root.get("unit", 100).asInt());
+    c.turn = calibrationUnits(root["turn"], c.unit, c.turn);
+    c.backward = calibrationUnits(root["backward"], c.unit, c.backward);
+    c.pick = calibrationUnits(root["pick"], c.unit, c.pick);
+    c.drop = calibrationUnits(root["drop"], c.unit, c.drop);
+    if (root["forward"].isObject()) {
+        c.forwardBase = calibrationUnits(root["forward"]["base"], c.unit, c.forwardBase);
+        if (root["forward"]["perCell"].isNumeric()) {
+            c.forwardPerCell = std::max(0, (int) ((root["forward"]["perCell"].asDouble() + c.unit / 2) / c.unit));
+        }
+    }
+    c.penalty = calibrationUnits(root["penalty"], c.unit, 100 * c.turn);
+    return c;
+}
+
+int
+Calibration::forward(int cells) const {
+    return forwardBase + forwardPerCell * cells;
+}
+
+int
+Calibration::longest(void) const {
+    return std::max(std::max(std::max(turn, backward), std::max(pick, drop)),
+                    forward(6));
+}
+
+PlannerOptions::PlannerOptions(void)
+  : threads(1.0), time(0), node(0), fail(0),
+    c_d(Search::Config::c_d), a_d(Search::Config::a_d), interrupt(false),
+    cancel(NULL) {}
+
+CancelToken::CancelToken(void) : fired(false), followed(NULL) {}
+
+void
+CancelToken::cancel(void) {
+    Support::Lock lock(mutex);
+    fired = true;
+}
+
+void
+CancelToken::reset(void) {
+    Support::Lock lock(mutex);
+    fired = false;
+}
+
+void
+CancelToken::follow(const CancelToken* token) {
+    Support::Lock lock(mutex);
+    followed = token;
+}
+
+bool
+CancelToken::cancelled(void) const {
+    Support::Lock lock(mutex);
+    return fired || (followed != NULL && followed->cancelled());
+}
+
+/// Reads a coordinate object {"x_coord":..,"y_coord":..} member by member
+/// into \a x and \a y. Returns false, if \a key is no coordinate.
+static bool decodeCoord(JsonDecoder& d, const string& key, int& x, int& y) {
+    if (key == "x_coord") {
+        x = d.readInt();
+    } else if (key == "y_coord") {
+        y = d.readInt();
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/// Reads a range {"min":..,"max":..}.
+static void decodeRange(JsonDecoder& d, int& min, int& max) {
+    string key;
+    if (d.beginObject()) {
+        while (d.nextMember(key)) {
+            if (key == "min") {
+                min = d.readInt();
+            } else if (key == "max") {
+                max = d.readInt();
+            } else {
+                d.skip();
+            }
+        }
+    }
+}
+
+/// Reads one robot of robot.js.
+static WarehouseRobot decodeRobot(JsonDecoder& d) {
+    WarehouseRobot robot;
+    int x = 0, y = 0;
+    robot.orientation = 0;
+    robot.backward = false;
+    string key;
+    if (d.beginObject()) {
+        while (d.nextMember(key)) {
+            if (decodeCoord(d, key, x, y)) {
+            } else if (key == "orientation") {
+                robot.orientation = d.readInt();
+            } else if (key == "backward") {
+                robot.backward = d.readBool();
+            } else {
+                d.skip();
+            }
+        }
+    }
+    robot.position = y * 7 + x;
+    return robot;
+}
+
+/// Reads one section of sections.js with its good.
+static WarehouseSection decodeSection(JsonDecoder& d) {
+    WarehouseSection section;
+    int x = 0, y = 0;
+    section.sensor = 0;
+    section.occupied = false;
+    section.good.tempMin = section.good.tempMax = 0;
+    section.good.lightMin = section.good.lightMax = 0;
+    string key;
+    if (d.beginObject()) {
+        while (d.nextMember(key)) {
+            if (decodeCoord(d, key, x, y)) {
+            } else if (key == "sensor") {
+                section.sensor = d.readInt();
+            } else if (key == "dock") {
+                section.dock = d.readString();
+            } else if (key == "status") {
+                section.occupied = d.readString() == "occupied";
+            } else if (key == "good" && d.peek() == '{') {
+                d.beginObject();
+                string goodKey;
+                while (d.nextMember(goodKey)) {
+                    if (goodKey == "name") {
+                        section.good.name = d.readString();
+                    } else if (goodKey == "desiredTemperature") {
+                        decodeRange(d, section.good.tempMin, section.good.tempMax);
+                    } else if (goodKey == "desiredLighting") {
+                        decodeRange(d, section.good.lightMin, section.good.lightMax);
+                    } else {
+                        d.skip();
+                    }
+                }
+            } else {
+                d.skip();
+            }
+        }
+    }
+    section.position = y * 7 + x;
+    section.good.position = section.position;
+    return section;
+}
+
+/// The files are mapped into memory and decoded in one pass, straight into
+/// the snapshot.
+WarehouseSnapshot
+WarehouseSnapshot::readJson(const string& robotFile, const string& sensorsFile,
+                            const string& sectionsFile) {
+    WarehouseSnapshot s;
+
+    /// Getting all information from the robots: position, orientation
+    /// and if it was a backward step as the last task. A single robot is
+    /// stored as an object, several robots as an array.
+    MappedFile robotData(robotFile);
+    JsonDecoder robotDecoder(robotData.data(), robotData.size());
+    s.robotArray = robotDecoder.peek() == '[';
+    if (s.robotArray) {
+        robotDecoder.beginArray();
+        while (robotDecoder.nextElement()) {
+            s.robots.push_back(decodeRobot(robotDecoder));
+        }
+    } else {
+        s.robots.push_back(decodeRobot(robotDecoder));
+    }
+    if (!robotDecoder.ok() || s.robots.empty()) {
+        throw runtime_error("cannot read the robots from " + robotFile);
+    }
+
+    // Getting all information about the sensors, including
+    // temperature and lighting.
+    MappedFile sensorsData(sensorsFile);
+    JsonDecoder sensorsDecoder(sensorsData.data(), sensorsData.size());
+    if (sensorsDecoder.beginArray()) {
+        while (sensorsDecoder.nextElement()) {
+            WarehouseSensor sensor;
+            sensor.id = s.sensors.size() + 1;
+            sensor.temperature = sensor.lighting = 0;
+            string key;
+            if (sensorsDecoder.beginObject()) {
+                while (sensorsDecoder.nextMember(key)) {
+                    if (key == "id") {
+                        sensor.id = sensorsDecoder.readInt();
+                    } else if (key == "temperature") {
+                        sensor.temperature = sensorsDecoder.readInt();
+                    } else if (key == "lighting") {
+                        sensor.lighting = sensorsDecoder.readInt();
+                    } else {
+                        sensorsDecoder.skip();
+                    }
+                }
+            }
+            s.sensors.push_back(sensor);
+        }
+    }
+
+    // Getting all information about the sections and the goods that
+    // may stored inside the sections.
+    MappedFile sectionsData(sectionsFile);
+    JsonDecoder sectionsDecoder(sectionsData.data(), sectionsData.size());
+    if (sectionsDecoder.beginArray()) {
+        while (sectionsDecoder.nextElement()) {
+            const char* begin = sectionsDecoder.position();
+            s.sections.push_back(decodeSection(sectionsDecoder));
+            s.sections.back().text.assign(begin, sectionsDecoder.position());
+        }
+    }
+    if (!sensorsDecoder.ok() || !sectionsDecoder.ok()) {
+        throw runtime_error("cannot read " + sensorsFile + " or " + sectionsFile);
+    }
+
+    s.journalSeq = s.snapshotSeq = 0;
+    s.classify();
+    return s;
+}
+
+/// The state of the binary snapshot file and the journal is only taken, if
+/// the JSON files were not changed since, e.g. by the web server.
+/// Otherwise the changed JSON files are taken and their changes are
+/// appended to the journal. The other JSON files may be older than the
+/// journal (see Planner::record). If the layout was changed, the state is
+/// written into a new binary snapshot file.
+WarehouseSnapshot
+WarehouseSnapshot::read(StateJournal& journal, const string& robotFile,
+                        const string& sensorsFile, const string& sectionsFile,
+                        const string& snapshotFile) {
+    FileStamp current[3] = { FileStamp::of(robotFile), FileStamp::of(sensorsFile),
+                             FileStamp::of(sectionsFile) };
+    bool recorded = false;
+    WarehouseSnapshot last;
+    FileStamp stamps[3];
+    {
+        SnapshotView view(snapshotFile);
+        if (view.valid()) {
+            last = view.snapshot();
+            for (int k = 0; k < 3; k++) {
+                stamps[k] = view.sources()[k];
+            }
+            journal.replay(last, stamps);
+            last.classify();
+            if (stamps[0] == current[0] && stamps[1] == current[1]
+                && stamps[2] == current[2]) {
+                return last;
+            }
+            recorded = true;
+        }
+    }
+
+    WarehouseSnapshot s = readJson(robotFile, sensorsFile, sectionsFile);
+    if (recorded) {
+        WarehouseSnapshot changed = last;
+        if (!(stamps[0] == current[0])) {
+            changed.robots = s.robots;
+            changed.robotArray = s.robotArray;
+        }
+        if (!(stamps[1] == current[1])) {
+            changed.sensors = s.sensors;
+        }
+        if (!(stamps[2] == current[2])) {
+            changed.sections = s.sections;
+        }
+        changed.classify();
+        s = changed;
+    }
+    if (recorded && StateJournal::sameLayout(last, s)
+        && journal.append(last.journalSeq + 1, last, s, current)) {
+        s.journalSeq = last.journalSeq + 1;
+        s.snapshotSeq = last.snapshotSeq;
+    } else {
+        s.journalSeq = s.snapshotSeq = recorded ? last.journalSeq : 0;
+        if (s.writeBinary(snapshotFile, robotFile, sensorsFile, sectionsFile)) {
+            journal.clear();
+        }
+    }
+    return s;
+}
+
+void
+WarehouseSnapshot::classify(void) {
+    warehousePosition.clear();
+    warehouseTemp.clear();
+    warehouseLight.clear();
+    garagePosition.clear();
+    inboundDocks.clear();
+    outboundDocks.clear();
+    for (unsigned int i = 0; i < sections.size(); ++i) {
+        const WarehouseSection& section = sections[i];
+        int sensor_int = section.sensor;
+        if (sensor_int > 0 && sensor_int <= (int) sensors.size()) {
+            warehousePosition.push_back(section.position);
+            warehouseTemp.push_back(sensors[sensor_int-1].temperature);
+            warehouseLight.push_back(sensors[sensor_int-1].lighting);
+        } else {
+            garagePosition.push_back(section.position);
+        }
+        if (section.dock == "inbound") {
+            inboundDocks.push_back(section.position);
+        } else if (section.dock == "outbound") {
+            outboundDocks.push_back(section.position);
+        }
+    }
+
+    // Without declared docks, the adding zone and the dropping zone are
+    // the docks.
+    if (inboundDocks.empty()) {
+        inboundDocks.push_back(8);
+    }
+    if (outboundDocks.empty()) {
+        outboundDocks.push_back(15);
+    }
+
+    collectGoods();
+}
+
+void
+WarehouseSnapshot::collectGoods(void) {
+    goods.clear();
+    for (unsigned int i = 0; i < sections.size(); ++i) {
+        if (sections[i].occupied) {
+            goods.push_back(sections[i].good);
+        }
+    }
+}
+
+void
+WarehouseSnapshot::writeRobots(JsonEncoder& e) const {
+    if (robotArray) {
+        e.beginArray();
+    }
+    for (unsigned int r = 0; r < robots.size(); ++r) {
+        e.beginObject();
+        e.key("backward");
+        e.value(robots[r].backward);
+        e.key("orientation");
+        e.value(robots[r].orientation);
+        e.key("x_coord");
+        e.value(robots[r].position % 7);
+        e.key("y_coord");
+        e.value(robots[r].position / 7);
+        e.endObject();
+        if (!robotArray) {
+            return;
+        }
+    }
+    e.endArray();
+}
+
+void
+WarehouseSnapshot::writeSensors(JsonEncoder& e) const {
+    e.beginArray();
+    for (unsigned int i = 0; i < sensors.size(); ++i) {
+        e.beginObject();
+        e.key("id");
+        e.value(sensors[i].id);
+        e.key("lighting");
+        e.value(sensors[i].lighting);
+        e.key("temperature");
+        e.value(sensors[i].temperature);
+        e.endObject();
+    }
+    e.endArray();
+}
+
+void
+WarehouseSnapshot::writeSections(JsonEncoder& e) const {
+    e.beginArray();
+    for (unsigned int i = 0; i < sections.size(); ++i) {
+        const WarehouseSection& section = sections[i];
+        if (!section.text.empty()) {
+            e.raw(section.text);
+            continue;
+        }
+        e.beginObject();
+        if (!section.dock.empty()) {
+            e.key("dock");
+            e.value(section.dock);
+        }
+        e.key("good");
+        if (section.occupied) {
+            e.beginObject();
+            e.key("desiredLighting");
+            e.beginObject();
+            e.key("max");
+            e.value(section.good.lightMax);
+            e.key("min");
+            e.value(section.good.lightMin);
+            e.endObject();
+            e.key("desiredTemperature");
+            e.beginObject();
+            e.key("max");
+            e.value(section.good.tempMax);
+            e.key("min");
+            e.value(section.good.tempMin);
+            e.endObject();
+            e.key("name");
+            e.value(section.good.name);
+            e.endObject();
+        } else {
+            e.value(false);
+        }
+        e.key("sensor");
+        if (section.sensor > 0) {
+            e.value(section.sensor);
+        } else {
+            e.value(false);
+        }
+        e.key("status");
+        e.value(section.occupied ? "occupied" : "free");
+        e.key("x_coord");
+        e.value(section.position % 7);
+        e.key("y_coord");
+        e.value(section.position / 7);
+        e.endObject();
+    }
+    e.endArray();
+}
+
+bool
+WarehouseSnapshot::writeJson(const string& robotFile, const string& sensorsFile,
+                             const string& sectionsFile) const {
+    AtomicFile robotsOut(robotFile);
+    JsonEncoder robotEncoder(robotsOut.stream());
+    writeRobots(robotEncoder);
+    AtomicFile sensorsOut(sensorsFile);
+    JsonEncoder sensorsEncoder(sensorsOut.stream());
+    writeSensors(sensorsEncoder);
+    AtomicFile sectionsOut(sectionsFile);
+    JsonEncoder sectionsEncoder(sectionsOut.stream());
+    writeSections(sectionsEncoder);
+    return robotsOut.commit() && sensorsOut.commit() && sectionsOut.commit();
+}
+
+bool
+WarehouseSnapshot::fits(const WarehouseGood& good, int warehouse) const {
+    return good.tempMin <= warehouseTemp[warehouse] && warehouseTemp[warehouse] <= good.tempMax
+      && good.lightMin <= warehouseLight[warehouse] && warehouseLight[warehouse] <= good.lightMax;
+}
+
+/// Returns true, if the sections \a a and \a b have the same status and
+/// the same good.
+static bool sameContents(const WarehouseSection& a, const WarehouseSection& b) {
+    if (a.occupied != b.occupied) {
+        return false;
+    }
+    return !a.occupied || (a.good.name == b.good.name
+                           && a.good.tempMin == b.good.tempMin && a.good.tempMax == b.good.tempMax
+                           && a.good.lightMin == b.good.lightMin && a.good.lightMax == b.good.lightMax);
+}
+
+WarehouseSnapshot
+WarehouseSnapshot::after(const WarehouseJob& job, const WarehousePlan& p) const {
+    WarehouseSnapshot n = *this;
+
+    // We have to update the robot coordinates, orientation and backward
+    // Bool of each robot
+    for (unsigned int r = 0; r < p.robots.size() && r < n.robots.size(); ++r) {
+        n.robots[r] = p.robots[r];
+    }
+
+    // Then we have to update all sections, including the status of the
+    // sections and the goods that may be stored there inside. A dropped
+    // good is not in the Warehouse anymore.
+    for (unsigned int i = 0; i < n.sections.size(); ++i) {
+        WarehouseSection& section = n.sections[i];
+        section.occupied = false;
+        for (unsigned int j = 0; j < job.goods.size(); j++) {
+            if (job.dropGood && (int) j == job.dropGoodNumber) {
+                continue;
+            }
+            if (p.goodsEndPositions[j] == section.position) {
+                section.occupied = true;
+                section.good = job.goods[j];
+                section.good.position = section.position;
+            }
+        }
+        if (!sameContents(section, sections[i])) {
+            section.text.clear();
+        }
+    }
+
+    n.collectGoods();
+    return n;
+}
+
+bool
+WarehouseSnapshot::same(const WarehouseSnapshot& s) const {
+    if (robotArray != s.robotArray || robots.size() != s.robots.size()
+        || sections.size() != s.sections.size()
+        || warehouseTemp != s.warehouseTemp || warehouseLight != s.warehouseLight) {
+        return false;
+    }
+    for (unsigned int r = 0; r < robots.size(); ++r) {
+        if (robots[r].position != s.robots[r].position
+            || robots[r].orientation != s.robots[r].orientation
+            || robots[r].backward != s.robots[r].backward) {
+            return false;
+        }
+    }
+    for (unsigned int i = 0; i < sections.size(); ++i) {
+        const WarehouseSection& a = sections[i];
+        const WarehouseSection& b = s.sections[i];
+        if (a.position != b.position || a.sensor != b.sensor || a.dock != b.dock
+            || !sameContents(a, b)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Manhattan distance between two positions of the Warehouse.
+static int positionDistance(int from, int to) {
+    return abs(from % 7 - to % 7) + abs(from / 7 - to / 7);
+}
+
+/// Idle-time re-slotting: searches the relocation of one good that brings
+/// the Warehouse closer to the layout with the lowest penalty cost.
+///
+/// A good is misplaced, if it stands at a garage place (no sensors) or at
+/// a Warehouse place that does not fit its temperature and light range.
+/// Each misplaced good costs a penalty of 100, so every relocation of a
+/// misplaced good to a free and fitting Warehouse place saves the same
+/// penalty. Therefore we take the relocation with the shortest distance,
+/// since it is the cheapest one for the robot.
+///
+/// The fitting places are found with \a index, or with an index that is
+/// built for \a s, if it is NULL.
+///
+/// Returns false, if there is no relocation that reduces the penalty.
+static bool findIdleRelocation(const WarehouseSnapshot& s,
+                               const Inventory& goods, const SlotIndex* index,
+                               int& goodNumber, int& fromPos, int& toPos) {
+    if (index == NULL) {
+        SlotIndex built(s);
+        return findIdleRelocation(s, goods, &built, goodNumber, fromPos, toPos);
+    }
+    bool found = false;
+    int bestDistance = 0;
+
+    for (int i = 0; i < goods.size(); i++) {
+        if (!goods.misplaced(i)) {
+            continue;
+        }
+
+        vector<int> freeSlots = index->compatibleFree(goods.good(i), goods);
+        for (unsigned int k = 0; k < freeSlots.size(); k++) {
+            int distance = positionDistance(goods.position(i), freeSlots[k]);
+            if (!found || distance < bestDistance) {
+                found = true;
+                bestDistance = distance;
+                goodNumber = i;
+                fromPos = goods.position(i);
+                toPos = freeSlots[k];
+            }
+        }
+    }
+
+    return found;
+}
+
+/// Idle-time pre-positioning: searches the street field for one robot,
+/// from which the expected way to the next order is the shortest.
+///
+/// The next order is expected at the locations of the recent orders in
+/// \a history (see app.js of the web server), each with the same
+/// probability; an add order starts at an inbound dock. The expected way
+/// from a field is the mean distance to these locations, an add order
+/// counts with the nearest inbound dock. The robot with
+/// the largest saving is moved, an other robot stays where it is.
+///
+/// Returns false, if no robot can shorten its expected way.
+static bool findIdlePosition(const WarehouseSnapshot& s,
+                             const Json::Value& history,
+                             int& robot, int& toPos) {
+    vector<int> locations;
+    for (unsigned int k = 0; k < history.size(); k++) {
+        if (!history[k].isObject()) {
+            continue;
+        }
+        if (history[k].get("job", "null").asString() == "add") {
+            locations.push_back(-1); // Inbound docks
+        } else {
+            // A location outside of the grid is no recent order.
+            int x = history[k]["x_coord"].asInt();
+            int y = history[k]["y_coord"].asInt();
+            if (x >= 0 && x <= 6 && y >= 0 && y <= 6) {
+                locations.push_back(y * 7 + x);
+            }
+        }
+    }
+    if (locations.empty()) {
+        return false;
+    }
+
+    // The robot only parks on the street, not in front of a section.
+    vector<bool> street(49, true);
+    for (unsigned int j = 0; j < s.warehousePosition.size(); j++) {
+        street[s.warehousePosition[j]] = false;
+    }
+    for (unsigned int j = 0; j < s.garagePosition.size(); j++) {
+        street[s.garagePosition[j]] = false;
+    }
+
+    // The sum of the distances is proportional to the expected way.
+    vector<int> expected(49, 0);
+    for (int pos = 0; pos < 49; pos++) {
+        for (unsigned int k = 0; k < locations.size(); k++) {
+            if (locations[k] >= 0) {
+                expected[pos] += positionDistance(pos, locations[k]);
+            } else {
+                int nearest = positionDistance(pos, s.inboundDocks[0]);
+                for (unsigned int d = 1; d < s.inboundDocks.size(); d++) {
+                    nearest = std::min(nearest, positionDistance(pos, s.inboundDocks[d]));
+                }
+                expected[pos] += nearest;
+            }
+        }
+    }
+
+    bool found = false;
+    int bestSaving = 0;
+    for (unsigned int r = 0; r < s.robots.size(); r++) {
+        for (int pos = 0; pos < 49; pos++) {
+            // Another robot must not stand there.
+            bool occupied = false;
+            for (unsigned int q = 0; q < s.robots.size(); q++) {
+                occupied = occupied || (q != r && s.robots[q].position == pos);
+            }
+            int saving = expected[s.robots[r].position] - expected[pos];
+            if (street[pos] && !occupied && saving > bestSaving) {
+                found = true;
+                bestSaving = saving;
+                robot = r;
+                toPos = pos;
+            }
+        }
+    }
+
+    return found;
+}
+
+/// Returns the coordinates (x,y) of the position \a pos for the messages.
+static string positionName(int pos) {
+    stringstream name;
+    name << "(" << pos % 7 << "," << pos / 7 << ")";
+    return name.str();
+}
+
+/// Returns the position of the coordinates \a coord {"x_coord":..,
+/// "y_coord":..} of an order. The web server sends the coordinates as
+/// strings, the positions of the grid are y * 7 + x.
+///
+/// Throws std::runtime_error, if a coordinate is missing or is not in
+/// 0..6, since the distances and the model only know the 7x7 grid.
+static int orderPosition(const Json::Value& coord) {
+    if (!coord.isObject() || !coord.isMember("x_coord") || !coord.isMember("y_coord")) {
+        throw runtime_error("an order without coordinates");
+    }
+    int x = atoi(coord["x_coord"].asString().c_str());
+    int y = atoi(coord["y_coord"].asString().c_str());
+    if (x < 0 || x > 6 || y < 0 || y > 6) {
+        stringstream error;
+        error << "the position (" << x << "," << y << ") is not in the Warehouse";
+        throw runtime_error(error.str());
+    }
+    return y * 7 + x;
+}
+
+/// Reads one order from \a job_root into \a job for the snapshot \a s.
+/// If it is an adding order, then \a job_add is set to this order, since
+/// the good is added later. The same holds for an idle order and
+/// \a job_idle.
+///
+/// Throws std::runtime_error, if a position of the order is not in the
+/// Warehouse, if the moves of a relocating order do not fit the snapshot,
+/// or if it is the second adding or removing order of a batch.
+static void readOrder(const Json::Value& job_root, const WarehouseSnapshot& s,
+                      WarehouseJob& job, Json::Value& job_add, Json::Value& job_idle) {
+
+        string job_kind = job_root.get("job", "null").asString();
+
+        if (job_kind == "move") {
+
+            // If its a moving task, redd the destination coordinates
+            // and transform the to the positions.
+            job.moving = true;
+            job.movingPos = orderPosition(job_root["to"]);
+            // With several robots, the order names the moving robot.
+            job.movingRobot = job_root.get("robot", 0).asInt();
+
+        }
+        else if (job_kind == "placeGood") {
+
+            // If its a placeGood task, read the starting and destination
+            // coordinates and transform them.
+            job.placeGoodFromPos.push_back(orderPosition(job_root["from"]));
+            job.placeGoodToPos.push_back(orderPosition(job_root["to"]));
+            job.numPickDrops++;
+
+        }
+        else if (job_kind == "relocate") {
+
+            // If its a relocate task, read all moves like placeGood tasks.
+            // The moves are done together in one plan, so the goods may
+            // swap their places. The free Warehouse and garage fields are
+            // the buffers between the moves.
+            //
+            // Each move must pick up a good of the snapshot, and two moves
+            // must not pick up or drop at the same place. A move may only
+            // drop at an occupied place, if another move picks up there.
+            // Otherwise the order is rejected, since a skipped move would
+            // leave a good at the place of another one.
+            const Json::Value& moves = job_root["moves"];
+            Inventory inventory(s);
+            map<int,int> toOfFrom;
+            map<int,bool> targets;
+            for (unsigned int k = 0; k < moves.size(); k++) {
+                int from_pos = orderPosition(moves[k]["from"]);
+                int to_pos = orderPosition(moves[k]["to"]);
+                if (inventory.at(from_pos) < 0) {
+                    throw runtime_error("relocate: no good to move at " + positionName(from_pos));
+                }
+                if (toOfFrom.find(from_pos) != toOfFrom.end() || targets.find(to_pos) != targets.end()) {
+                    throw runtime_error("relocate: two moves at " + positionName(from_pos)
+                                        + " or " + positionName(to_pos));
+                }
+                toOfFrom[from_pos] = to_pos;
+                targets[to_pos] = true;
+            }
+            for (map<int,int>::iterator it = toOfFrom.begin(); it != toOfFrom.end(); ++it) {
+                if (inventory.at(it->second) >= 0 && toOfFrom.find(it->second) == toOfFrom.end()) {
+                    throw runtime_error("relocate: the place " + positionName(it->second)
+                                        + " is occupied");
+                }
+                // A good that stays at its place needs no pick up and drop.
+                if (it->first != it->second) {
+                    job.placeGoodFromPos.push_back(it->first);
+                    job.placeGoodToPos.push_back(it->second);
+                    job.numPickDrops++;
+                }
+            }
+
+            // Each cycle of the moves (like a swap A->B, B->A) needs one
+            // more pick up and drop pair, since one good of the cycle has
+            // to wait at a buffer.
+            map<int,bool> visited;
+            for (map<int,int>::iterator it = toOfFrom.begin(); it != toOfFrom.end(); ++it) {
+                if (visited[it->first]) {
+                    continue;
+                }
+                int pos = it->first;
+                do {
+                    visited[pos] = true;
+                    pos = toOfFrom[pos];
+                } while (pos != it->first && toOfFrom.find(pos) != toOfFrom.end()
+                         && !visited[pos]);
+                if (pos == it->first && it->second != it->first) {
+                    job.numPickDrops++;
+                }
+            }
+
+        }
+        else if (job_kind == "add") {
+
+            // If its a add task, we will add the good later, after the
+            // goods of the snapshot. A job has only one added good, since
+            // all of them would use the same inbound docks.
+            if (job.addGood) {
+                throw runtime_error("add: two adding orders in one batch");
+            }
+            job.addGood = true;
+            job_add = job_root;
+            job.numPickDrops++;
+
+        }
+        else if (job_kind == "remove") {
+
+            // If its a removing/dropping task, then read the starting
+            // corrdination of this good and transform it into the
+            // position. A job has only one removed good (see add).
+            if (job.dropGood) {
+                throw runtime_error("remove: two removing orders in one batch");
+            }
+            job.dropGood = true;
+            job.dropGoodFromPos = orderPosition(job_root["from"]);
+            job.numPickDrops++;
+
+        }
+        else if (job_kind == "idle") {
+
+            // If its an idle job, then the queue of the orders is empty.
+            // We will search for a relocation later, since we need all
+            // goods of the job.
+            job.idle = true;
+            job_idle = job_root;
+            job.numPickDrops++;
+
+        }
+        // Otherwise we have no user job task
+}
+
+WarehouseJob
+WarehouseJob::read(const Json::Value& input, const WarehouseSnapshot& s,
+                   const SlotIndex* slots) {
+    WarehouseJob job;
+    job.moving = false;
+    job.movingPos = 0;
+    job.movingRobot = 0;
+    job.addGood = false;
+    job.dropGood = false;
+    job.dropGoodFromPos = 0;
+    job.dropGoodNumber = 0;
+    job.idle = false;
+    job.dummyGood = false;
+    job.numPickDrops = 0;
+    job.maxTasks = defaultMaxTasks;
+
+    // Either a single order or a batch of orders (JSON array) that will be
+    // planned together in one run.
+    Json::Value job_add;
+    Json::Value job_idle;
+    if (input.isArray()) {
+        for (unsigned int k = 0; k < input.size(); k++) {
+            readOrder(input[k], s, job, job_add, job_idle);
+        }
+    } else {
+        readOrder(input, s, job, job_add, job_idle);
+    }
+
+    // An unknown robot is the first robot.
+    if (job.movingRobot < 0 || job.movingRobot >= (int) s.robots.size()) {
+        job.movingRobot = 0;
+    }
+
+    job.goods = s.goods;
+
+    // If it is as adding good task, we will add this good at one of the
+    // free inbound docks. If all inbound docks are occupied, there is no
+    // plan.
+    if (job.addGood) {
+        for (unsigned int k = 0; k < s.inboundDocks.size(); k++) {
+            bool isFree = true;
+            for (unsigned int j = 0; j < job.goods.size(); j++) {
+                isFree = isFree && job.goods[j].position != s.inboundDocks[k];
+            }
+            if (isFree) {
+                job.addDocks.push_back(s.inboundDocks[k]);
+            }
+        }
+        if (job.addDocks.empty()) {
+            job.addDocks = s.inboundDocks;
+        }
+
+        WarehouseGood good;
+        good.name = job_add["good"]["name"].asString();
+        good.position = job.addDocks[0]; // Starting Position for Adding Goods
+        good.tempMin = atoi(job_add["good"]["desiredTemperature"]["min"].asString().c_str());
+        good.tempMax = atoi(job_add["good"]["desiredTemperature"]["max"].asString().c_str());
+        good.lightMin = atoi(job_add["good"]["desiredLighting"]["min"].asString().c_str());
+        good.lightMax = atoi(job_add["good"]["desiredLighting"]["max"].asString().c_str());
+        job.goods.push_back(good);
+    }
+
+    // Remember, if there is a removing job, before the dummy good
+    // may set the dropping task.
+    bool jobRemove = job.dropGood;
+
+    // If we have no good, then we will add a dummy good at the
+    // dropping zone, so that the robot will do nothing. This workaround
+    // is needed, that all constraints for the goods are working.
+    if (job.goods.empty()) {
+        job.dummyGood = true;
+        job.dropGood = true;
+        job.dropGoodNumber = 0;
+        job.dropGoodFromPos = s.outboundDocks[0];
+
+        WarehouseGood good;
+        good.name = "DummyGood";
+        good.position = s.outboundDocks[0]; // Starting Position for Dropping Goods
+        good.tempMin = -100;
+        good.tempMax = 2000;
+        good.lightMin = -1000;
+        good.lightMax = 2000;
+        job.goods.push_back(good);
+    }
+
+    // If its a placeGood job, then we can calculate now, at which
+    // index this good is stored in the goods. A placeGood job without
+    // a good at the starting position is skipped, and so is its pick up
+    // and drop pair.
+    Inventory inventory(s, job.goods);
+    vector<int> placeGoodFromPos;
+    vector<int> placeGoodToPos;
+    for (unsigned int k = 0; k < job.placeGoodFromPos.size(); k++) {
+        int j = inventory.at(job.placeGoodFromPos[k]);
+        if (j >= 0) {
+            job.placeGoodNumber.push_back(j);
+            placeGoodFromPos.push_back(job.placeGoodFromPos[k]);
+            placeGoodToPos.push_back(job.placeGoodToPos[k]);
+        } else {
+            job.numPickDrops--;
+        }
+    }
+    job.placeGoodFromPos = placeGoodFromPos;
+    job.placeGoodToPos = placeGoodToPos;
+
+    if (jobRemove) {
+
+        // The same we will do, if we are dropping a good.
+        int j = inventory.at(job.dropGoodFromPos);
+        if (j >= 0) {
+            job.dropGoodNumber = j;
+        } else {
+            job.dropGood = false;
+            job.numPickDrops--;
+        }
+    }
+
+    // A single moving job will not need more than 7 tasks. Otherwise,
+    // each further pick up and drop pair of a batch needs more tasks.
+    if (job.moving && job.numPickDrops == 0) {
+        job.maxTasks = movingMaxTasks;
+    } else if (job.numPickDrops > 1) {
+        job.maxTasks += batchTasksPerPickDrop * (job.numPickDrops - 1);
+    }
+    if (job.numPickDrops == 0) {
+        job.numPickDrops = 1;
+    }
+    if (job.idle && !job.dummyGood) {
+
+        // If its an idle job, then we are looking for a misplaced good
+        // and plan the relocation of this good like a placeGood job.
+        // If all goods are at a fitting place, the robot moves towards
+        // the recent orders like a moving job, or it does nothing.
+        int goodNumber, fromPos, toPos;
+        if (findIdleRelocation(s, inventory, slots, goodNumber, fromPos, toPos)) {
+            job.placeGoodNumber.push_back(goodNumber);
+            job.placeGoodFromPos.push_back(fromPos);
+            job.placeGoodToPos.push_back(toPos);
+        } else if (findIdlePosition(s, job_idle["history"], job.movingRobot, toPos)) {
+            job.moving = true;
+            job.movingPos = toPos;
+            job.maxTasks = movingMaxTasks;
+        }
+    }
+
+    return job;
+}
+
+
+
+
+/* -------------------------------
+ *  PLANNER
+ *  -------------------------------
+ */
+
+/// Stop object of a search: the limits of the options, Ctrl-C and the
+/// cancellation token.
+class PlannerStop : public Search::Stop {
+protected:
+  Search::Stop* limits;
+  const CancelToken* token;
+public:
+  PlannerStop(const PlannerOptions& o)
+    : limits(CombinedStop::create(o.node, o.fail, o.time, o.interrupt)),
+      token(o.cancel) {}
+  ~PlannerStop(void) {
+    delete limits;
+  }
+  virtual bool stop(const Search::Statistics& s, const Search::Options& o) {
+    return (token != NULL && token->cancelled())
+      || (limits != NULL && limits->stop(s,o));
+  }
+};
+
+Planner::Planner(const Calibration& calibration) : _calibration(calibration) {}
+
+const Calibration&
+Planner::calibration(void) const {
+    return _calibration;
+}
+
+Planner::~Planner(void) {
+    for (map<vector<int>, Warehouse*>::iterator it = roots.begin();
+         it != roots.end(); ++it) {
+        delete it->second;
+    }
+}
+
+Warehouse*
+Planner::space(const WarehouseSnapshot& s, const WarehouseJob& job) {
+    // A root space depends only on the number of tasks, the number of
+    // goods and the number of robots, so it is built and propagated once
+    // and then cloned for every job.
+    Support::Lock lock(rootsMutex);
+    vector<int> key;
+    key.push_back(job.maxTasks);
+    key.push_back(job.goods.size());
+    key.push_back(s.robots.size());
+    if (roots.find(key) == roots.end()) {
+        Warehouse* root = new Warehouse(job.maxTasks, job.goods.size(), s.robots.size(), _calibration);
+        if (root->status() == SS_FAILED) {
+            delete root;
+            root = NULL;
+        }
+        roots[key] = root;
+    }
+    if (roots[key] == NULL) {
+        return NULL;
+    }
+    // The clone is searched on the calling thread, e.g. the thread of a
+    // speculative job, while other threads clone the same root. Gecode
+    // allows this only for a clone that shares no data with the root.
+    return static_cast<Warehouse*>(roots[key]->clone(false));
+}
+
+WarehousePlan
+Planner::solve(const WarehouseSnapshot& s, const WarehouseJob& job,
+               const PlannerOptions& o) {
+    WarehousePlan p;
+
+    Warehouse* w = space(s, job);
+    if (w == NULL) {
+        return p;
+    }
+    // Only the constraints of the job are posted on a clone of the
+    // propagated root space of the layout.
+    w->postJob(s, job);
+
+    PlannerStop stop(o);
+    Search::Options so;
+    so.threads = o.threads;
+    so.c_d     = o.c_d;
+    so.a_d     = o.a_d;
+    so.stop    = &stop;
+    so.clone   = false;
+    // The handler of Ctrl-C is only installed during the search, so that
+    // Ctrl-C between the jobs still ends the planner.
+    if (o.interrupt) {
+        CombinedStop::installCtrlHandler(true);
+    }
+    // A solution without instructions ends the search, the error is
+    // thrown after the handler of Ctrl-C is removed again.
+    string error;
+    {
+        // Branch and bound: each solution is better than the previous
+        // one, so the last solution is the best one.
+        BAB<Warehouse> e(w, so);
+        while (Warehouse* ex = e.next()) {
+            try {
+                p = ex->plan(s, job);
+            } catch (const runtime_error& err) {
+                error = err.what();
+            }
+            delete ex;
+            if (!error.empty()) {
+                break;
+            }
+        }
+        // Only a complete search (not stopped by a limit) gives the
+        // optimal plan.
+        p.complete = !e.stopped();
+        p.cancelled = e.stopped() && o.cancel != NULL && o.cancel->cancelled();
+    }
+    if (o.interrupt) {
+        CombinedStop::installCtrlHandler(false);
+    }
+    if (!error.empty()) {
+        throw runtime_error("Cannot plan the job: " + error);
+    }
+
+    return p;
+}
+
+/// Shared state of the threads that plan hypothetical jobs: each thread
+/// takes the next job that is not planned yet. The threads search their
+/// own unshared clones of the root (see Planner::space), also while a
+/// speculative job searches another clone of the same root.
+class WhatIfPool {
+public:
+  Planner& planner;
+  const WarehouseSnapshot& snapshot;
+  const vector<WarehouseJob>& jobs;
+  PlannerOptions options;
+  vector<WarehousePlan> plans;
+  /// Next job and number of running threads
+  unsigned int next;
+  unsigned int running;
+  Support::Mutex mutex;
+  Support::Event finished;
+
+  WhatIfPool(Planner& p, const WarehouseSnapshot& s,
+             const vector<WarehouseJob>& j, const PlannerOptions& o)
+    : planner(p), snapshot(s), jobs(j), options(o), plans(j.size()),
+      next(0), running(0) {
+    // The handler of Ctrl-C is process-wide, the threads must not install
+    // and remove it concurrently.
+    options.interrupt = false;
+  }
+};
+
+/// Thread of the hypothetical jobs.
+class WhatIfWorker : public Support::Runnable {
+protected:
+  WhatIfPool& pool;
+public:
+  WhatIfWorker(WhatIfPool& p) : pool(p) {}
+  virtual void run(void) {
+    while (true) {
+      unsigned int i;
+      {
+        Support::Lock lock(pool.mutex);
+        if (pool.next >= pool.jobs.size()) {
+          break;
+        }
+        i = pool.next++;
+      }
+      // A job that cannot be planned keeps the empty plan.
+      try {
+        pool.plans[i] = pool.planner.solve(pool.snapshot, pool.jobs[i], pool.options);
+      } catch (const exception&) {
+      }
+    }
+    {
+      Support::Lock lock(pool.mutex);
+      pool.running--;
+    }
+    pool.finished.signal();
+  }
+};
+
+vector<WarehousePlan>
+Planner::evaluate(const WarehouseSnapshot& s, const vector<WarehouseJob>& jobs,
+                  const PlannerOptions& o, unsigned int threads) {
+    WhatIfPool pool(*this, s, jobs, o);
+    if (threads > jobs.size()) {
+        threads = jobs.size();
+    }
+    pool.running = threads;
+    for (unsigned int t = 0; t < threads; t++) {
+        Support::Thread::run(new WhatIfWorker(pool));
+    }
+    while (true) {
+        {
+            Support::Lock lock(pool.mutex);
+            if (pool.running == 0) {
+                break;
+            }
+        }
+        pool.finished.wait();
+    }
+    return pool.plans;
+}
+
+WarehouseSnapshot
+Planner::write(const WarehouseSnapshot& s, const WarehouseJob& job,
+               const WarehousePlan& p, StateJournal& journal,
+               const string& robotFile, const string& sensorsFile,
+               const string& sectionsFile, const string& snapshotFile) {
+    WarehouseSnapshot n = s.after(job, p);
+    if (!n.same(s)) {
+        record(s, n, journal, robotFile, sensorsFile, sectionsFile, snapshotFile);
+    }
+    return n;
+}
+
+void
+Planner::record(const WarehouseSnapshot& s, WarehouseSnapshot& n,
+                StateJournal& journal, const string& robotFile,
+                const string& sensorsFile, const string& sectionsFile,
+                const string& snapshotFile) {
+    // Only the changes are appended to the journal, with the stamps of the
+    // unchanged JSON files. From time to time, the state is exported to
+    // the JSON files and compacted into a new binary snapshot, which is
+    // stamped with the new JSON files.
+    FileStamp stamps[3] = { FileStamp::of(robotFile), FileStamp::of(sensorsFile),
+                            FileStamp::of(sectionsFile) };
+    n.journalSeq = s.journalSeq + 1;
+    bool appended = journal.append(n.journalSeq, s, n, stamps);
+    if (!appended || n.journalSeq - s.snapshotSeq >= journalCompaction) {
+        // Without the binary snapshot, the exported JSON files are read
+        // again the next time (their stamps changed).
+        bool exported = n.writeJson(robotFile, sensorsFile, sectionsFile);
+        if (n.writeBinary(snapshotFile, robotFile, sensorsFile, sectionsFile)) {
+            journal.clear();
+            n.snapshotSeq = n.journalSeq;
+        } else if (!appended && !exported) {
+            throw runtime_error("cannot record the state");
+        }
+    }
+}
+
+
+
+
+/* -------------------------------
+ *  SPECULATIVE PLANNING
+ *  -------------------------------
+ */
+
+/// A speculative job and its plan.
+class Speculation::Result {
+public:
+  Json::Value input;
+  WarehouseSnapshot snapshot;
+  WarehouseJob job;
+  PlannerOptions options;
+  CancelToken token;
+  WarehousePlan plan;
+  /// The plan is finished, and the job was discarded.
+  bool done;
+  bool discarded;
+};
+
+/// Background thread of a speculative job.
+class Speculation::Runner : public Support::Runnable {
+protected:
+  Speculation& speculation;
+  Result* result;
+public:
+  Runner(Speculation& s, Result* r) : speculation(s), result(r) {}
+  virtual void run(void) {
+    // A job that cannot be planned keeps the empty plan, the foreground
+    // plans it again (see Speculation::take).
+    WarehousePlan p;
+    try {
+      p = speculation.planner.solve(result->snapshot, result->job,
+                                    result->options);
+    } catch (const exception&) {
+    }
+    {
+      Support::Lock lock(speculation.mutex);
+      result->plan = p;
+      result->done = true;
+      if (result->discarded) {
+        delete result;
+      }
+      speculation.running--;
+    }
+    speculation.finished.signal();
+  }
+};
+
+Speculation::Speculation(Planner& p)
+  : planner(p), current(NULL), running(0) {}
+
+Speculation::~Speculation(void) {
+    discard();
+    while (true) {
+        {
+            Support::Lock lock(mutex);
+            if (running == 0) {
+                break;
+            }
+        }
+        finished.wait();
+    }
+}
+
+void
+Speculation::discard(void) {
+    if (current == NULL) {
+        return;
+    }
+    Support::Lock lock(mutex);
+    if (current->done) {
+        delete current;
+    } else {
+        // Stop the search, it is not needed anymore.
+        current->token.cancel();
+        current->discarded = true;
+    }
+    current = NULL;
+}
+
+void
+Speculation::start(const Json::Value& input, const WarehouseSnapshot& s,
+                   const PlannerOptions& o) {
+    discard();
+
+    Result* r = new Result;
+    r->input = input;
+    r->snapshot = s;
+    r->job = WarehouseJob::read(input, s);
+    r->options = o;
+    r->options.cancel = &r->token;
+    // Ctrl-C stops the job in the foreground, not the speculative one.
+    r->options.interrupt = false;
+    r->done = false;
+    r->discarded = false;
+    current = r;
+
+    {
+        Support::Lock lock(mutex);
+        running++;
+    }
+    Support::Thread::run(new Runner(*this, r));
+}
+
+bool
+Speculation::take(const Json::Value& input, const WarehouseSnapshot& s,
+                  WarehousePlan& p, const CancelToken* cancel) {
+    // If the execution of the robot diverged from the prediction, or the
+    // next job is another one, the speculative plan is worthless.
+    if (current == NULL || !(current->input == input) || !current->snapshot.same(s)) {
+        discard();
+        return false;
+    }
+
+    // The speculative search is the search of the job now: it is stopped
+    // like the search of any other job, e.g. by a preemption.
+    current->token.follow(cancel);
+    while (true) {
+        {
+            Support::Lock lock(mutex);
+            if (current->done) {
+                break;
+            }
+        }
+        finished.wait();
+    }
+    p = current->plan;
+    discard();
+    return p.found;
+}
+
+
+
+
+/* -------------------------------
+ *  SEQUENCING OF THE ORDERS
+ *  -------------------------------
+ */
+
+/// Computes the distances between all positions of the Warehouse for the
+/// robot with a breadth-first search over the street fields. A Warehouse
+/// or garage field can only be entered from a neighbouring street field,
+/// so it is never used as a part of a path.
+static void computeGridDistances(int distances[49][49]) {
+    // Help Array for the 33 street fields.
+    int streetFields [33] = {0,1,2,3,4,5,6,7,10,13,14,17,20,21,22,23,24,25,26,27,28,31,34,35,38,41,42,43,44,45,46,47,48};
+    bool isStreet [49];
+    for (int pos = 0; pos < 49; pos++) {
+        isStreet[pos] = false;
+    }
+    for (int k = 0; k < 33; k++) {
+        isStreet[streetFields[k]] = true;
+    }
+
+    int stepX [4] = {0, 1, 0, -1};
+    int stepY [4] = {1, 0, -1, 0};
+
+    for (int from = 0; from < 49; from++) {
+        for (int pos = 0; pos < 49; pos++) {
+            distances[from][pos] = -1;
+        }
+        distances[from][from] = 0;
+
+        int queue [49];
+        int queueBegin = 0;
+        int queueEnd = 0;
+        queue[queueEnd++] = from;
+
+        while (queueBegin < queueEnd) {
+            int pos = queue[queueBegin++];
+            // Only the start and the street fields can be left.
+            if (pos != from && !isStreet[pos]) {
+                continue;
+            }
+            for (int d = 0; d < 4; d++) {
+                int x = pos % 7 + stepX[d];
+                int y = pos / 7 + stepY[d];
+                if (x < 0 || x > 6 || y < 0 || y > 6) {
+                    continue;
+                }
+                int next = y * 7 + x;
+                // Two Warehouse fields are not connected.
+                if (!isStreet[pos] && !isStreet[next]) {
+                    continue;
+                }
+                if (distances[from][next] == -1) {
+                    distances[from][next] = distances[from][pos] + 1;
+                    queue[queueEnd++] = next;
+                }
+            }
+        }
+    }
+}
+
+/// Reads the position, where the robot starts and ends an order. The first
+/// inbound dock is the start of an adding order and the nearest outbound
+/// dock the end of a removing order. The end of an adding order is not
+/// known before planning, so the inbound dock is taken. A relocating order
+/// starts at its first move and ends at its last move.
+///
+/// Throws std::runtime_error, if a position is not in the Warehouse (see
+/// orderPosition).
+static void orderEndpoints(const Json::Value& order, const WarehouseSnapshot& s,
+                           int distances[49][49], int& startPos, int& endPos) {
+    string job_kind = order.get("job", "null").asString();
+
+    if (job_kind == "move") {
+        startPos = orderPosition(order["to"]);
+        endPos = startPos;
+    } else if (job_kind == "placeGood") {
+        startPos = orderPosition(order["from"]);
+        endPos = orderPosition(order["to"]);
+    } else if (job_kind == "relocate" && order["moves"].size() > 0) {
+        const Json::Value& moves = order["moves"];
+        startPos = orderPosition(moves[0]["from"]);
+        endPos = orderPosition(moves[moves.size()-1]["to"]);
+    } else if (job_kind == "remove") {
+        int from_pos = orderPosition(order["from"]);
+        startPos = from_pos;
+        endPos = s.outboundDocks[0];
+        for (unsigned int k = 1; k < s.outboundDocks.size(); k++) {
+            if (distances[from_pos][s.outboundDocks[k]] < distances[from_pos][endPos]) {
+                endPos = s.outboundDocks[k];
+            }
+        }
+    } else {
+        startPos = s.inboundDocks[0];
+        endPos = s.inboundDocks[0];
+    }
+}
+
+/// Reads the sections, where an order takes or puts a good: the from and
+/// to section of a placeGood, the from section of a remove, all sections
+/// of the moves of a relocate and the inbound docks of an add.
+static vector<int> orderSections(const Json::Value& order, const WarehouseSnapshot& s) {
+    string job_kind = order.get("job", "null").asString();
+    vector<int> sections;
+    if (job_kind == "placeGood" || job_kind == "remove") {
+        sections.push_back(orderPosition(order["from"]));
+    }
+    if (job_kind == "placeGood") {
+        sections.push_back(orderPosition(order["to"]));
+    } else if (job_kind == "relocate") {
+        const Json::Value& moves = order["moves"];
+        for (unsigned int m = 0; m < moves.size(); m++) {
+            sections.push_back(orderPosition(moves[m]["from"]));
+            sections.push_back(orderPosition(moves[m]["to"]));
+        }
+    } else if (job_kind == "add") {
+        sections = s.inboundDocks;
+    }
+    return sections;
+}
+
+/// Travel cost of the robot for a sequence of orders starting at \a robotPos.
+static int sequenceCost(const vector<int>& sequence, const vector<int>& startPos,
+                        const vector<int>& endPos, int robotPos, int distances[49][49]) {
+    int cost = 0;
+    int pos = robotPos;
+    for (unsigned int k = 0; k < sequence.size(); k++) {
+        cost += distances[pos][startPos[sequence[k]]];
+        pos = endPos[sequence[k]];
+    }
+    return cost;
+}
+
+/// Checks, if no order of the sequence is placed after its latest position
+/// and no order before an order of \a after (the earlier orders that use
+/// one of its sections). The sequence may hold only a part of the orders.
+static bool sequenceFeasible(const vector<int>& sequence, const vector<int>& latest,
+                             const vector<vector<int> >& after) {
+    vector<int> position(latest.size(), -1);
+    for (unsigned int k = 0; k < sequence.size(); k++) {
+        if ((int) k > latest[sequence[k]]) {
+            return false;
+        }
+        position[sequence[k]] = k;
+    }
+    for (unsigned int k = 0; k < sequence.size(); k++) {
+        const vector<int>& earlier = after[sequence[k]];
+        for (unsigned int l = 0; l < earlier.size(); l++) {
+            if (position[earlier[l]] > (int) k) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/// Sequencing of the pending orders: reorders the \a orders, so that the
+/// travel of the robot between the orders (from the end of one order to
+/// the start of the next one) is minimal.
+///
+/// This is a path version of the travelling salesman problem, that is
+/// solved with the nearest insertion heuristic and improved with 2-opt.
+/// Each order may define a "deadline", which is the latest position of
+/// this order in the sequence. Otherwise an order will not be delayed by
+/// more than sequenceMaxDelay positions. Two orders that use the same
+/// section (e.g. placeGood A to B and placeGood C to A) keep their order,
+/// since the later one depends on the earlier one. If the nearest
+/// insertion does not respect these bounds, the 2-opt starts from the
+/// original order (FIFO), which always respects them.
+///
+/// The robot starts at the position of the robot of the first order that
+/// names one, like a moving order. Throws std::runtime_error, if a
+/// position of an order is not in the Warehouse.
+Json::Value sequenceOrders(const Json::Value& orders, const WarehouseSnapshot& s) {
+    int distances [49][49];
+    computeGridDistances(distances);
+    int robot = 0;
+    for (unsigned int k = 0; k < orders.size(); k++) {
+        if (orders[k].isObject() && orders[k].isMember("robot")) {
+            robot = orders[k]["robot"].asInt();
+            break;
+        }
+    }
+    // An unknown robot is the first robot (see WarehouseJob::read).
+    if (robot < 0 || robot >= (int) s.robots.size()) {
+        robot = 0;
+    }
+    int robotPos = s.robots[robot].position;
+
+    int numOrders = orders.size();
+    vector<int> startPos(numOrders);
+    vector<int> endPos(numOrders);
+    vector<int> latest(numOrders);
+    vector<vector<int> > sections(numOrders);
+    vector<vector<int> > after(numOrders);
+    for (int k = 0; k < numOrders; k++) {
+        sections[k] = orderSections(orders[k], s);
+        for (int l = 0; l < k; l++) {
+            bool shared = false;
+            for (unsigned int m = 0; m < sections[k].size() && !shared; m++) {
+                shared = find(sections[l].begin(), sections[l].end(), sections[k][m]) != sections[l].end();
+            }
+            if (shared) {
+                after[k].push_back(l);
+            }
+        }
+        orderEndpoints(orders[k], s, distances, startPos[k], endPos[k]);
+        latest[k] = orders[k].get("deadline", k + sequenceMaxDelay).asInt();
+        if (latest[k] < k) {
+            // Never earlier than the FIFO position, so that the FIFO
+            // order is always feasible.
+            latest[k] = k;
+        }
+    }
+
+    // Nearest insertion: take the order that is the nearest one to the
+    // robot or to one order of the sequence and insert it at the position
+    // with the lowest additional cost.
+    vector<int> sequence;
+    vector<bool> inserted(numOrders, false);
+    bool insertionFeasible = true;
+    for (int n = 0; n < numOrders && insertionFeasible; n++) {
+        int nearest = -1;
+        int nearestDistance = 0;
+        for (int k = 0; k < numOrders; k++) {
+            if (inserted[k]) {
+                continue;
+            }
+            int distance = distances[robotPos][startPos[k]];
+            for (unsigned int l = 0; l < sequence.size(); l++) {
+                distance = std::min(distance, distances[endPos[sequence[l]]][startPos[k]]);
+                distance = std::min(distance, distances[endPos[k]][startPos[sequence[l]]]);
+            }
+            if (nearest == -1 || distance < nearestDistance) {
+                nearest = k;
+                nearestDistance = distance;
+            }
+        }
+
+        int bestPosition = -1;
+        int bestCost = 0;
+        for (unsigned int l = 0; l <= sequence.size(); l++) {
+            vector<int> candidate = sequence;
+            candidate.insert(candidate.begin() + l, nearest);
+            int cost = sequenceCost(candidate, startPos, endPos, robotPos, distances);
+            if (sequenceFeasible(candidate, latest, after) && (bestPosition == -1 || cost < bestCost)) {
+                bestPosition = l;
+                bestCost = cost;
+            }
+        }
+
+        if (bestPosition == -1) {
+            insertionFeasible = false;
+        } else {
+            sequence.insert(sequence.begin() + bestPosition, nearest);
+            inserted[nearest] = true;
+        }
+    }
+
+    if (!insertionFeasible) {
+        sequence.clear();
+        for (int k = 0; k < numOrders; k++) {
+            sequence.push_back(k);
+        }
+    }
+
+    // 2-opt: reverse a part of the sequence, as long as it makes the
+    // sequence cheaper and respects the latest positions.
+    bool improved = true;
+    int bestCost = sequenceCost(sequence, startPos, endPos, robotPos, distances);
+    while (improved) {
+        improved = false;
+        for (int i = 0; i < numOrders - 1; i++) {
+            for (int j = i + 1; j < numOrders; j++) {
+                vector<int> candidate = sequence;
+                std::reverse(candidate.begin() + i, candidate.begin() + j + 1);
+                int cost = sequenceCost(candidate, startPos, endPos, robotPos, distances);
+                if (cost < bestCost && sequenceFeasible(candidate, latest, after)) {
+                    sequence = candidate;
+                    bestCost = cost;
+                    improved = true;
+                }
+            }
+        }
+    }
+
+    Json::Value result(Json::arrayValue);
+    for (int k = 0; k < numOrders; k++) {
+        result.append(orders[sequence[k]]);
+    }
+    return result;
+}
+
+
+
+
+/* -------------------------------
+ *  PLAN CACHE
+ *  -------------------------------
+ */
+
+/// Key of a feature with a value for the Zobrist hashing. The keys are
+/// the values of a fixed random generator (splitmix64), so that they are
+/// the same in each run and the hashes can be stored on disk.
+static unsigned long long zobristKey(unsigned long long feature, long long value) {
+    unsigned long long z = (feature << 32) + (unsigned long long) value + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/// Zobrist key of the temperature and light range of a good at a position.
+static unsigned long long zobristGoodKey(const WarehouseGood& good) {
+    unsigned long long key = zobristKey(10, good.position);
+    key = zobristKey(11, key ^ good.tempMin);
+    key = zobristKey(12, key ^ good.tempMax);
+    key = zobristKey(13, key ^ good.lightMin);
+    return zobristKey(14, key ^ good.lightMax);
+}
+
+/// Version of the instructions of the cached plans (2: SYNC between the
+/// robots).
+static const int instructionFormat = 2;
+
+/// Fingerprint of the layout, the sensors, the calibration and the format
+/// of the instructions. If it changes, all plans of the cache are invalid.
+static unsigned long long layoutFingerprint(const WarehouseSnapshot& s,
+                                            const Calibration& c) {
+    unsigned long long hash = zobristKey(4020, c.turn);
+    hash ^= zobristKey(4027, instructionFormat);
+    hash ^= zobristKey(4021, c.backward);
+    hash ^= zobristKey(4022, c.pick);
+    hash ^= zobristKey(4023, c.drop);
+    hash ^= zobristKey(4024, c.forwardBase);
+    hash ^= zobristKey(4025, c.forwardPerCell);
+    hash ^= zobristKey(4026, c.penalty);
+    for (unsigned int j = 0; j < s.warehousePosition.size(); j++) {
+        hash ^= zobristKey(20 + j, s.warehousePosition[j]);
+        hash ^= zobristKey(1020 + j, s.warehouseTemp[j]);
+        hash ^= zobristKey(2020 + j, s.warehouseLight[j]);
+    }
+    for (unsigned int j = 0; j < s.garagePosition.size(); j++) {
+        hash ^= zobristKey(3020 + j, s.garagePosition[j]);
+    }
+    for (unsigned int j = 0; j < s.inboundDocks.size(); j++) {
+        hash ^= zobristKey(5020 + j, s.inboundDocks[j]);
+    }
+    for (unsigned int j = 0; j < s.outboundDocks.size(); j++) {
+        hash ^= zobristKey(6020 + j, s.outboundDocks[j]);
+    }
+    return hash;
+}
+
+static string hashString(unsigned long long hash) {
+    stringstream stringStreamHash;
+    stringStreamHash << hex << setw(16) << setfill('0') << hash;
+    return stringStreamHash.str();
+}
+
+PlanCache::PlanCache(const string& file0, unsigned int size0)
+  : file(file0), size(size0), counter(0), loaded(false), dirty(false) {}
+
+static bool cachedPlanLess(const CachedPlan& a, const CachedPlan& b) {
+    return a.key < b.key;
+}
+
+vector<CachedPlan>::iterator
+PlanCache::find(const string& key) {
+    CachedPlan probe;
+    probe.key = key;
+    return lower_bound(plans.begin(), plans.end(), probe, cachedPlanLess);
+}
+
+/// Reads one plan of the cache. A plan of an older cache without the
+/// robot states has no robots and is dropped.
+static CachedPlan decodeCachedPlan(JsonDecoder& d) {
+    CachedPlan plan;
+    plan.dock = -1;
+    plan.used = 0;
+    string key;
+    if (d.beginObject()) {
+        while (d.nextMember(key)) {
+            if (key == "instructions") {
+                plan.instructions = d.readString();
+            } else if (key == "dock") {
+                plan.dock = d.readInt(-1);
+            } else if (key == "used") {
+                plan.used = d.readInt();
+            } else if (key == "robots" && d.beginArray()) {
+                while (d.nextElement()) {
+                    WarehouseRobot robot;
+                    robot.position = 0;
+                    robot.orientation = 0;
+                    robot.backward = false;
+                    string robotKey;
+                    if (d.beginObject()) {
+                        while (d.nextMember(robotKey)) {
+                            if (robotKey == "position") {
+                                robot.position = d.readInt();
+                            } else if (robotKey == "orientation") {
+                                robot.orientation = d.readInt();
+                            } else if (robotKey == "backward") {
+                                robot.backward = d.readBool();
+                            } else {
+                                d.skip();
+                            }
+                        }
+                    }
+                    plan.robots.push_back(robot);
+                }
+            } else if (key == "moves" && d.beginArray()) {
+                while (d.nextElement()) {
+                    pair<int,int> move(0, 0);
+                    string moveKey;
+                    if (d.beginObject()) {
+                        while (d.nextMember(moveKey)) {
+                            if (moveKey == "from") {
+                                move.first = d.readInt();
+                            } else if (moveKey == "to") {
+                                move.second = d.readInt();
+                            } else {
+                                d.skip();
+                            }
+                        }
+                    }
+                    plan.moves.push_back(move);
+                }
+            } else {
+                d.skip();
+            }
+        }
+    }
+    return plan;
+}
+
+void
+PlanCache::read(const WarehouseSnapshot& s, const Calibration& c) {
+    string current = hashString(layoutFingerprint(s, c));
+    if (loaded && current == layout) {
+        return;
+    }
+    layout = current;
+    counter = 0;
+    plans.clear();
+    // After the first read, the cache on disk is the cache in memory (or
+    // an older version of it) for the old layout, it is discarded, too.
+    if (loaded) {
+        return;
+    }
+    loaded = true;
+
+    MappedFile data(file);
+    JsonDecoder d(data.data(), data.size());
+    string fileLayout;
+    string key;
+    if (d.beginObject()) {
+        while (d.nextMember(key)) {
+            if (key == "layout") {
+                fileLayout = d.readString();
+            } else if (key == "counter") {
+                counter = d.readInt();
+            } else if (key == "plans" && d.beginObject()) {
+                string planKey;
+                while (d.nextMember(planKey)) {
+                    CachedPlan plan = decodeCachedPlan(d);
+                    if (!plan.robots.empty()) {
+                        plan.key = planKey;
+                        plans.push_back(plan);
+                    }
+                }
+            } else {
+                d.skip();
+            }
+        }
+    }
+    if (!d.ok() || fileLayout != layout) {
+        counter = 0;
+        plans.clear();
+    }
+    sort(plans.begin(), plans.end(), cachedPlanLess);
+}
+
+/// The cache is written in the format of the Json::FastWriter.
+bool
+PlanCache::write(void) {
+    if (!dirty) {
+        return true;
+    }
+    AtomicFile out(file);
+    std::ostream& ofs = out.stream();
+    ofs << "{\"counter\":" << counter
+        << ",\"layout\":" << Json::valueToQuotedString(layout.c_str())
+        << ",\"plans\":{";
+    for (unsigned int k = 0; k < plans.size(); k++) {
+        const CachedPlan& plan = plans[k];
+        ofs << (k > 0 ? "," : "")
+            << Json::valueToQuotedString(plan.key.c_str())
+            << ":{\"dock\":" << plan.dock
+            << ",\"instructions\":"
+            << Json::valueToQuotedString(plan.instructions.c_str())
+            << ",\"moves\":[";
+        for (unsigned int m = 0; m < plan.moves.size(); m++) {
+            ofs << (m > 0 ? "," : "")
+                << "{\"from\":" << plan.moves[m].first
+                << ",\"to\":" << plan.moves[m].second << "}";
+        }
+        ofs << "],\"robots\":[";
+        for (unsigned int r = 0; r < plan.robots.size(); r++) {
+            ofs << (r > 0 ? "," : "")
+                << "{\"backward\":" << (plan.robots[r].backward ? "true" : "false")
+                << ",\"orientation\":" << plan.robots[r].orientation
+                << ",\"position\":" << plan.robots[r].position << "}";
+        }
+        ofs << "],\"used\":" << plan.used << "}";
+    }
+    ofs << "}}\n";
+    // A cache that cannot be written keeps its last complete version, the
+    // plans are found again by the search.
+    if (!out.commit()) {
+        return false;
+    }
+    dirty = false;
+    return true;
+}
+
+/// The relevant goods are the goods of the jobs. If the jobs allow more
+/// pick up and drop pairs than they need, then the planner may move any
+/// misplaced good and all goods are relevant.
+string
+PlanCache::key(const WarehouseSnapshot& s, const WarehouseJob& job) {
+    unsigned long long hash = 0;
+    for (unsigned int r = 0; r < s.robots.size(); r++) {
+        hash ^= zobristKey(0, r * 49 + s.robots[r].position);
+        hash ^= zobristKey(1, r * 4 + s.robots[r].orientation);
+        hash ^= zobristKey(2, r * 2 + s.robots[r].backward);
+    }
+    hash ^= zobristKey(3, job.maxTasks);
+    hash ^= zobristKey(4, job.numPickDrops);
+
+    int numGoods = job.goods.size();
+    vector<bool> relevant(numGoods, false);
+    int numTargets = 0;
+    for (int j = 0; j < numGoods; j++) {
+        hash ^= zobristKey(5, job.goods[j].position);
+    }
+    if (job.moving) {
+        hash ^= zobristKey(6, job.movingRobot * 49 + job.movingPos);
+    }
+    for (unsigned int k = 0; k < job.placeGoodNumber.size(); k++) {
+        hash ^= zobristKey(7, job.placeGoodFromPos[k] * 49 + job.placeGoodToPos[k]);
+        relevant[job.placeGoodNumber[k]] = true;
+        numTargets++;
+    }
+    if (job.addGood) {
+        hash ^= zobristKey(8, 1);
+        relevant[numGoods-1] = true;
+        numTargets++;
+    }
+    if (job.dropGood) {
+        hash ^= zobristKey(9, job.dropGoodFromPos);
+        relevant[job.dropGoodNumber] = true;
+        numTargets++;
+    }
+    for (int j = 0; j < numGoods; j++) {
+        if (relevant[j] || numTargets < job.numPickDrops) {
+            hash ^= zobristGoodKey(job.goods[j]);
+        }
+    }
+    return hashString(hash);
+}
+
+/// Takes a plan from the cache: the instructions, the final robot states
+/// and the end positions of the goods (only the moved goods are stored).
+bool
+PlanCache::load(const string& key, const WarehouseJob& job, WarehousePlan& p) {
+    vector<CachedPlan>::iterator plan = find(key);
+    if (plan == plans.end() || plan->key != key) {
+        return false;
+    }
+
+    p = WarehousePlan();
+    p.found = true;
+    p.complete = true;
+    p.instructions = plan->instructions;
+    p.addDock = plan->dock;
+    p.robots = plan->robots;
+
+    for (unsigned int j = 0; j < job.goods.size(); j++) {
+        int endPosition = job.goods[j].position;
+        for (unsigned int k = 0; k < plan->moves.size(); k++) {
+            if (plan->moves[k].first == job.goods[j].position) {
+                endPosition = plan->moves[k].second;
+            }
+        }
+        p.goodsEndPositions.push_back(endPosition);
+    }
+
+    // Remember when the plan was used for the last time.
+    plan->used = ++counter;
+    dirty = true;
+    return true;
+}
+
+/// If the cache is full, the plan that was not used for the longest time
+/// is removed.
+void
+PlanCache::store(const string& key, const WarehouseJob& job, const WarehousePlan& p) {
+    vector<CachedPlan>::iterator existing = find(key);
+    if (existing != plans.end() && existing->key == key) {
+        plans.erase(existing);
+    }
+    if (!plans.empty() && plans.size() >= size) {
+        vector<CachedPlan>::iterator oldest = plans.begin();
+        for (vector<CachedPlan>::iterator it = plans.begin(); it != plans.end(); ++it) {
+            if (it->used < oldest->used) {
+                oldest = it;
+            }
+        }
+        plans.erase(oldest);
+    }
+
+    CachedPlan plan;
+    plan.key = key;
+    plan.instructions = p.instructions;
+    plan.dock = p.addDock;
+    plan.robots = p.robots;
+    for (unsigned int j = 0; j < job.goods.size(); j++) {
+        if (p.goodsEndPositions[j] != job.goods[j].position) {
+            plan.moves.push_back(make_pair(job.goods[j].position, p.goodsEndPositions[j]));
+        }
+    }
+    plan.used = ++counter;
+    plans.insert(find(key), plan);
+    dirty = true;
+}
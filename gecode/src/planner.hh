@@ -0,0 +1,473 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main author:
+ *     Michael Brendle <michaelbrendle@me.com>
+ *
+ */
+
+#ifndef __WAREHOUSE_PLANNER_HH__
+#define __WAREHOUSE_PLANNER_HH__
+
+#include <gecode/int.hh>
+#include <gecode/minimodel.hh>
+#include <gecode/search.hh>
+
+#include "jsoncpp/json/json.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+/* -------------------------------
+ *  PLANNER LIBRARY
+ *
+ *  The planner takes an immutable snapshot of the Warehouse and a job and
+ *  returns a plan. All state is carried in the instances, so several jobs
+ *  can be planned in one process, also on separate threads.
+ *  -------------------------------
+ */
+
+class Warehouse;
+class JsonEncoder;
+class StateJournal;
+class SlotIndex;
+class WarehouseJob;
+class WarehousePlan;
+
+/// A good with its position and its temperature and light range.
+class WarehouseGood {
+public:
+  std::string name;
+  int position;
+  int tempMin;
+  int tempMax;
+  int lightMin;
+  int lightMax;
+};
+
+/// A robot with its position, its orientation and its last backward
+/// movement.
+class WarehouseRobot {
+public:
+  int position;
+  int orientation;
+  bool backward;
+};
+
+/// A section of the Warehouse (an entry of sections.js) with the good
+/// that is stored there.
+class WarehouseSection {
+public:
+  int position;
+  /// Number of the sensor (1, 2, ...), 0 for a garage place.
+  int sensor;
+  /// "inbound", "outbound" or empty, if the section is no dock.
+  std::string dock;
+  bool occupied;
+  WarehouseGood good;
+  /// JSON text of the section as read from sections.js, or empty, if the
+  /// status or the good changed and the section has to be encoded again.
+  std::string text;
+};
+
+/// A sensor of sensors.js. The sensor of a section is its number in the
+/// order of sensors.js (1, 2, ...).
+class WarehouseSensor {
+public:
+  int id;
+  int temperature;
+  int lighting;
+};
+
+/// Snapshot of the Warehouse: the robots, the goods, the Warehouse places
+/// with the values of their sensors and the garage places.
+///
+/// The positions are encoded as y_coord * 7 + x_coord (see Warehouse).
+class WarehouseSnapshot {
+public:
+  /// All robots in the Warehouse. robot.js holds either one robot (an
+  /// object) or several robots (an array).
+  std::vector<WarehouseRobot> robots;
+  bool robotArray;
+
+  /// All sensors, in the order of sensors.js.
+  std::vector<WarehouseSensor> sensors;
+
+  /// All sections, in the order of sections.js.
+  std::vector<WarehouseSection> sections;
+
+  /// All goods in the Warehouse.
+  std::vector<WarehouseGood> goods;
+
+  /// Position, temperature and light of the Warehouse places.
+  std::vector<int> warehousePosition;
+  std::vector<int> warehouseTemp;
+  std::vector<int> warehouseLight;
+
+  /// Position of the garage places (no sensors).
+  std::vector<int> garagePosition;
+
+  /// Position of the docks, where goods are added (inbound) and dropped
+  /// (outbound). A section is a dock with "dock":"inbound" or "outbound".
+  /// Without docks in the sections, the adding zone (8) and the dropping
+  /// zone (15) are the docks.
+  std::vector<int> inboundDocks;
+  std::vector<int> outboundDocks;
+
+  /// Number of the last change of the journal in this snapshot and in the
+  /// binary snapshot file (see StateJournal).
+  unsigned int journalSeq;
+  unsigned int snapshotSeq;
+
+  /// Reads the snapshot from the binary snapshot file and replays the
+  /// changes of the journal \a journal (see SnapshotView and
+  /// StateJournal). If a JSON file was changed since, e.g. by the web
+  /// server, it is read and its changes are appended to the journal.
+  static WarehouseSnapshot read(StateJournal& journal,
+                                const std::string& robotFile = "robot.js",
+                                const std::string& sensorsFile = "sensors.js",
+                                const std::string& sectionsFile = "sections.js",
+                                const std::string& snapshotFile = "snapshot.bin");
+  /// Reads the snapshot from the JSON files in one pass over each file
+  /// (see JsonDecoder).
+  static WarehouseSnapshot readJson(const std::string& robotFile,
+                                    const std::string& sensorsFile,
+                                    const std::string& sectionsFile);
+
+  /// Derives the Warehouse places, the garage places, the docks and the
+  /// goods from the sensors and the sections.
+  void classify(void);
+  /// Collects the goods from the sections.
+  void collectGoods(void);
+
+  /// Writes the robots, the sensors and the sections, as they are stored
+  /// in robot.js, sensors.js and sections.js. Unchanged sections are
+  /// copied as they were read.
+  void writeRobots(JsonEncoder& e) const;
+  void writeSensors(JsonEncoder& e) const;
+  void writeSections(JsonEncoder& e) const;
+  /// Exports the state to the JSON files. Each file is replaced atomically
+  /// (see AtomicFile). Returns false, if a file could not be written.
+  bool writeJson(const std::string& robotFile,
+                 const std::string& sensorsFile,
+                 const std::string& sectionsFile) const;
+  /// Writes the binary snapshot file, stamped with the JSON files of the
+  /// same state (see SnapshotView). Returns false, if the file could not
+  /// be written: the JSON files are read again the next time.
+  bool writeBinary(const std::string& snapshotFile,
+                   const std::string& robotFile,
+                   const std::string& sensorsFile,
+                   const std::string& sectionsFile) const;
+
+  /// Returns the snapshot after the robot has executed the plan \a p of
+  /// the job \a job.
+  WarehouseSnapshot after(const WarehouseJob& job, const WarehousePlan& p) const;
+
+  /// Returns true, if the snapshot has the same robot, sensors and sections
+  /// as \a s.
+  bool same(const WarehouseSnapshot& s) const;
+
+  /// Returns true, if the good fits the temperature and the light of the
+  /// Warehouse place \a warehouse.
+  bool fits(const WarehouseGood& good, int warehouse) const;
+};
+
+/// A job for the planner: one or more orders (a batch), normalized to the
+/// positions and the goods of a snapshot.
+class WarehouseJob {
+public:
+  /// Moving task, moving position and the robot that has to move.
+  bool moving;
+  int movingPos;
+  int movingRobot;
+
+  /// Placing good tasks including from positions, to positions and good
+  /// numbers (one entry for each placeGood order).
+  std::vector<int> placeGoodFromPos;
+  std::vector<int> placeGoodNumber;
+  std::vector<int> placeGoodToPos;
+
+  /// Adding a good (the last good of goods) and the free inbound docks,
+  /// where the good may be added.
+  bool addGood;
+  std::vector<int> addDocks;
+
+  /// Dropping a good.
+  bool dropGood;
+  int dropGoodFromPos;
+  int dropGoodNumber;
+
+  /// Idle job: relocation of a misplaced good (re-slotting).
+  bool idle;
+
+  /// A dummy good, when no good is in the Warehouse (border case).
+  bool dummyGood;
+
+  /// Number of pick up and drop pairs and maximal number of tasks.
+  int numPickDrops;
+  int maxTasks;
+
+  /// The goods of the model: the goods of the snapshot and maybe the added
+  /// good or the dummy good.
+  std::vector<WarehouseGood> goods;
+
+  /// Reads the job from \a input (a single order or an array of orders)
+  /// for the snapshot \a s. Throws std::runtime_error for an invalid
+  /// order, e.g. a position that is not in the Warehouse, or for a batch
+  /// with two adding or two removing orders. The fitting places of an
+  /// idle job are found with \a slots, if it is given.
+  static WarehouseJob read(const Json::Value& input, const WarehouseSnapshot& s,
+                           const SlotIndex* slots = NULL);
+};
+
+/// A plan of the robot for a job.
+class WarehousePlan {
+public:
+  /// A solution was found, and the search was complete (optimal plan).
+  bool found;
+  bool complete;
+  /// The search was stopped by its cancellation token.
+  bool cancelled;
+
+  /// Instructions for the robots, the instructions of the robots are
+  /// separated by "|".
+  std::string instructions;
+
+  /// Final position, orientation and last backward movement of the robots.
+  std::vector<WarehouseRobot> robots;
+
+  /// End positions of the goods of the job.
+  std::vector<int> goodsEndPositions;
+
+  /// Inbound dock, where the added good has to be put, -1 if no good is
+  /// added.
+  int addDock;
+
+  /// Cost of the robot tasks (the estimated duration) and penalty cost of
+  /// the goods.
+  int robotCost;
+  int penaltyCost;
+
+  WarehousePlan(void);
+};
+
+/// Cancellation token of a search. It can be fired from another thread,
+/// then the search stops at the next node and keeps the best plan found
+/// so far.
+class CancelToken {
+protected:
+  mutable Gecode::Support::Mutex mutex;
+  bool fired;
+  /// Token that cancels this token as well, NULL if there is none.
+  const CancelToken* followed;
+public:
+  CancelToken(void);
+  /// Stops the search.
+  void cancel(void);
+  /// Makes the token usable for the next search.
+  void reset(void);
+  /// The search is stopped also by the token \a token (NULL for none).
+  void follow(const CancelToken* token);
+  bool cancelled(void) const;
+};
+
+/// Estimated durations of the robot instructions in cost units, fitted
+/// from measured executions of the robot (see calibrate.js of the web
+/// server). Without a calibration every instruction costs 1, so the plan
+/// with the fewest tasks is the best one.
+class Calibration {
+public:
+  /// Milliseconds of one cost unit.
+  int unit;
+  /// Duration of a turn, a backward step, a pick up and a drop.
+  int turn;
+  int backward;
+  int pick;
+  int drop;
+  /// Duration of a forward movement: base + perCell * number of cells.
+  int forwardBase;
+  int forwardPerCell;
+  /// Penalty of a good that is not at a fitting Warehouse place.
+  int penalty;
+
+  Calibration(void);
+  /// Reads the calibration from \a file (durations in milliseconds). If
+  /// there is no file, the default calibration is returned.
+  static Calibration read(const std::string& file = "calibration.js");
+
+  /// Duration of a forward movement of \a cells cells.
+  int forward(int cells) const;
+  /// Duration of the longest instruction.
+  int longest(void) const;
+};
+
+/// Limits of the search for one job. A value of 0 means no limit.
+class PlannerOptions {
+public:
+  double threads;
+  unsigned int time;
+  unsigned int node;
+  unsigned int fail;
+  /// Commit and adaptive recomputation distance of the search.
+  unsigned int c_d;
+  unsigned int a_d;
+  /// Ctrl-C stops the search and keeps the best plan found so far.
+  bool interrupt;
+  /// Cancellation token of the search, NULL if it cannot be cancelled.
+  CancelToken* cancel;
+
+  PlannerOptions(void);
+};
+
+/// The planner. It keeps the propagated root spaces of the layout, so that
+/// a job only clones a root space and posts its own constraints.
+class Planner {
+protected:
+  /// Durations of the instructions for the cost of the plans.
+  Calibration _calibration;
+  /// Root spaces for each number of tasks, goods and robots.
+  std::map<std::vector<int>, Warehouse*> roots;
+  /// Protects the root spaces, since cloning a space is not thread-safe.
+  Gecode::Support::Mutex rootsMutex;
+
+  /// Returns a clone of the root space for the job, or NULL if the
+  /// layout has no solution. The clone shares no data with the root, so
+  /// it can be searched on any thread (what-if workers, speculation).
+  Warehouse* space(const WarehouseSnapshot& s, const WarehouseJob& job);
+public:
+  Planner(const Calibration& calibration = Calibration());
+  ~Planner(void);
+
+  const Calibration& calibration(void) const;
+
+  /// Plans the job \a job for the snapshot \a s.
+  WarehousePlan solve(const WarehouseSnapshot& s, const WarehouseJob& job,
+                      const PlannerOptions& o);
+
+  /// Plans the hypothetical jobs \a jobs for the snapshot \a s in parallel
+  /// on \a threads threads. Each job is limited by the options \a o.
+  std::vector<WarehousePlan> evaluate(const WarehouseSnapshot& s,
+                                      const std::vector<WarehouseJob>& jobs,
+                                      const PlannerOptions& o,
+                                      unsigned int threads);
+
+  /// Records the state after the plan \a p in the journal \a journal
+  /// (see record) and returns it. A plan that changes nothing, e.g. an
+  /// idle job without a relocation, is not recorded.
+  static WarehouseSnapshot write(const WarehouseSnapshot& s, const WarehouseJob& job,
+                    const WarehousePlan& p, StateJournal& journal,
+                    const std::string& robotFile = "robot.js",
+                    const std::string& sensorsFile = "sensors.js",
+                    const std::string& sectionsFile = "sections.js",
+                    const std::string& snapshotFile = "snapshot.bin");
+  /// Appends the changes from \a s to \a n to the journal and sets
+  /// n.journalSeq. Only the journal is written for a change. If it cannot
+  /// be written or it is too long, the state is compacted: it is exported
+  /// to the JSON files and written into a new binary snapshot file, and
+  /// the journal is cleared. Between the compactions, the JSON files are
+  /// older than the state (see WarehouseSnapshot::read).
+  static void record(const WarehouseSnapshot& s, WarehouseSnapshot& n,
+                     StateJournal& journal,
+                     const std::string& robotFile = "robot.js",
+                     const std::string& sensorsFile = "sensors.js",
+                     const std::string& sectionsFile = "sections.js",
+                     const std::string& snapshotFile = "snapshot.bin");
+};
+
+/// Speculative planning: while the robot executes the current plan, the
+/// next job is solved in a background thread against the snapshot that is
+/// predicted by the current plan. The result is only taken, if the next
+/// job and the actual snapshot are the same as predicted.
+class Speculation {
+protected:
+  class Result;
+  class Runner;
+  Planner& planner;
+  /// The current speculative job, NULL if there is none.
+  Result* current;
+  /// Protects the results and the number of running jobs.
+  Gecode::Support::Mutex mutex;
+  Gecode::Support::Event finished;
+  unsigned int running;
+
+  /// Drops the current speculative job. A running job is deleted by its
+  /// thread, when it has finished.
+  void discard(void);
+public:
+  Speculation(Planner& planner);
+  /// Waits for all running speculative jobs.
+  ~Speculation(void);
+
+  /// Starts to plan the job \a input for the predicted snapshot \a s.
+  void start(const Json::Value& input, const WarehouseSnapshot& s,
+             const PlannerOptions& o);
+  /// Takes the plan \a p of the speculative job, if it was started for
+  /// the job \a input and the snapshot \a s. Waits for the plan, if it
+  /// is not finished yet, unless the token \a cancel (if not NULL) stops
+  /// the search before. Otherwise the speculative job is discarded.
+  bool take(const Json::Value& input, const WarehouseSnapshot& s,
+            WarehousePlan& p, const CancelToken* cancel = NULL);
+};
+
+/// A plan of the cache with the final robot states. Only the moved goods
+/// are stored, as pairs of the start and the end position.
+struct CachedPlan {
+  std::string key;
+  std::string instructions;
+  int dock;
+  std::vector<WarehouseRobot> robots;
+  std::vector<std::pair<int,int> > moves;
+  /// Value of the counter when the plan was used for the last time.
+  int used;
+};
+
+/// Cache of the plans, keyed by a hash of the snapshot and the job, that
+/// is stored on disk. The plans are kept flat in a vector sorted by the
+/// key, instead of a Json::Value tree with a map node and a copied key for
+/// each member.
+///
+/// The resident planner keeps one cache for all its jobs: it is read from
+/// disk once, and a hit only changes the counters in memory, which are
+/// written with the next stored plan or at the end.
+class PlanCache {
+protected:
+  std::string file;
+  unsigned int size;
+  std::string layout;
+  int counter;
+  std::vector<CachedPlan> plans;
+  /// The cache was read from disk, and it has changed since it was
+  /// written.
+  bool loaded;
+  bool dirty;
+
+  /// Position of \a key in the plans, or of the plan after it.
+  std::vector<CachedPlan>::iterator find(const std::string& key);
+public:
+  PlanCache(const std::string& file = "plancache.js", unsigned int size = 500);
+
+  /// Reads the cache for the layout and the sensors of \a s and the
+  /// calibration \a c. A cache of another layout, other sensor values or
+  /// another calibration is discarded. Only the first call reads the
+  /// disk, later calls keep the cache in memory, if the layout is the
+  /// same.
+  void read(const WarehouseSnapshot& s, const Calibration& c);
+  /// Writes the cache to disk, if it has changed. Returns false, if it
+  /// could not be written; it stays changed then.
+  bool write(void);
+
+  /// Hash of the robot state, the occupied places, the relevant goods and
+  /// the normalized job.
+  static std::string key(const WarehouseSnapshot& s, const WarehouseJob& job);
+
+  /// Takes the plan \a p for \a key from the cache, if it is there.
+  bool load(const std::string& key, const WarehouseJob& job, WarehousePlan& p);
+  /// Stores the plan \a p for \a key in the cache.
+  void store(const std::string& key, const WarehouseJob& job, const WarehousePlan& p);
+};
+
+/// Reorders the \a orders for the robot of the orders in the snapshot
+/// \a s, so that the travel of the robot between the orders is minimal.
+Json::Value sequenceOrders(const Json::Value& orders, const WarehouseSnapshot& s);
+
+#endif
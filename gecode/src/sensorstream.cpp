@@ -0,0 +1,214 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main author:
+ *     Michael Brendle <michaelbrendle@me.com>
+ *
+ */
+
+#include "sensorstream.hh"
+
+#include <cmath>
+
+using namespace std;
+
+SensorWindow::SensorWindow(void)
+  : head(0), count(0), tempSum(0), lightSum(0) {}
+
+void
+SensorWindow::push(int temperature, int lighting) {
+    if (count == sensorWindow) {
+        tempSum -= temps[head];
+        lightSum -= lights[head];
+    } else {
+        count++;
+    }
+    temps[head] = temperature;
+    lights[head] = lighting;
+    tempSum += temperature;
+    lightSum += lighting;
+    head = (head + 1) % sensorWindow;
+}
+
+bool
+SensorWindow::empty(void) const {
+    return count == 0;
+}
+
+int
+SensorWindow::temperature(void) const {
+    return (int) floor((double) tempSum / count + 0.5);
+}
+
+int
+SensorWindow::lighting(void) const {
+    return (int) floor((double) lightSum / count + 0.5);
+}
+
+Json::Value
+SensorWindow::json(void) const {
+    Json::Value v;
+    int tempMin = temps[0], tempMax = temps[0];
+    int lightMin = lights[0], lightMax = lights[0];
+    for (int k = 1; k < count; k++) {
+        tempMin = min(tempMin, temps[k]);
+        tempMax = max(tempMax, temps[k]);
+        lightMin = min(lightMin, lights[k]);
+        lightMax = max(lightMax, lights[k]);
+    }
+    v["temperature"]["mean"] = temperature();
+    v["temperature"]["min"] = tempMin;
+    v["temperature"]["max"] = tempMax;
+    v["lighting"]["mean"] = lighting();
+    v["lighting"]["min"] = lightMin;
+    v["lighting"]["max"] = lightMax;
+    return v;
+}
+
+SensorStream::SensorStream(int p, StateJournal& j)
+  : penalty(p), journal(j), stale(true), fit(NULL), slots(NULL), penaltyCost(0) {}
+
+SensorStream::~SensorStream(void) {
+    delete fit;
+    delete slots;
+}
+
+void
+SensorStream::load(void) {
+    s = WarehouseSnapshot::read(journal);
+    written = s;
+    if (windows.size() < s.sensors.size()) {
+        windows.resize(s.sensors.size());
+    }
+    delete fit;
+    fit = new FitMatrix(s, s.goods);
+    slotIndex(s);
+
+    int sensorAt[49];
+    int warehouseAt[49];
+    for (int p = 0; p < 49; p++) {
+        sensorAt[p] = 0;
+        warehouseAt[p] = -1;
+    }
+    for (unsigned int i = 0; i < s.sections.size(); i++) {
+        if (s.sections[i].position >= 0 && s.sections[i].position < 49) {
+            sensorAt[s.sections[i].position] = s.sections[i].sensor;
+        }
+    }
+    for (unsigned int w = 0; w < s.warehousePosition.size(); w++) {
+        int p = s.warehousePosition[w];
+        if (p >= 0 && p < 49) {
+            warehouseAt[p] = w;
+        }
+    }
+
+    placeOf.clear();
+    penalties.clear();
+    goodsOf.assign(s.sensors.size() + 1, vector<int>());
+    penaltyCost = 0;
+    for (unsigned int g = 0; g < s.goods.size(); g++) {
+        int p = s.goods[g].position;
+        int w = p >= 0 && p < 49 ? warehouseAt[p] : -1;
+        placeOf.push_back(w);
+        if (w >= 0) {
+            goodsOf[sensorAt[p]].push_back(g);
+        }
+        penalties.push_back(w >= 0 && fit->fits(g, w) ? 0 : penalty);
+        penaltyCost += penalties[g];
+    }
+    stale = false;
+}
+
+Json::Value
+SensorStream::ingest(const Json::Value& reading) {
+    if (stale) {
+        load();
+    }
+    if (!reading["id"].isNumeric() || !reading["temperature"].isNumeric()
+        || !reading["lighting"].isNumeric()) {
+        return Json::Value();
+    }
+    int id = reading["id"].asInt();
+    if (id < 1 || id > (int) s.sensors.size()) {
+        return Json::Value();
+    }
+
+    SensorWindow& window = windows[id-1];
+    window.push(reading["temperature"].asInt(), reading["lighting"].asInt());
+    WarehouseSensor& sensor = s.sensors[id-1];
+    if (sensor.temperature == window.temperature() && sensor.lighting == window.lighting()) {
+        return Json::Value();
+    }
+    sensor.temperature = window.temperature();
+    sensor.lighting = window.lighting();
+    slots->update(id, sensor.temperature, sensor.lighting);
+
+    // Only the goods at the places of this sensor can leave or reenter
+    // their range.
+    if (fit->update(id, sensor.temperature, sensor.lighting) == 0) {
+        return Json::Value();
+    }
+    Json::Value goods(Json::arrayValue);
+    const vector<int>& affected = goodsOf[id];
+    for (unsigned int k = 0; k < affected.size(); k++) {
+        int g = affected[k];
+        int p = fit->fits(g, placeOf[g]) ? 0 : penalty;
+        if (p == penalties[g]) {
+            continue;
+        }
+        penaltyCost += p - penalties[g];
+        penalties[g] = p;
+        Json::Value good;
+        good["name"] = s.goods[g].name;
+        good["x_coord"] = s.goods[g].position % 7;
+        good["y_coord"] = s.goods[g].position / 7;
+        good["inRange"] = p == 0;
+        goods.append(good);
+    }
+    if (goods.empty()) {
+        return Json::Value();
+    }
+
+    Json::Value alert = window.json();
+    alert["sensor"] = id;
+    alert["goods"] = goods;
+    alert["penaltyCost"] = penaltyCost;
+    flush();
+    return alert;
+}
+
+void
+SensorStream::flush(void) {
+    if (stale) {
+        return;
+    }
+    bool changed = false;
+    for (unsigned int i = 0; i < s.sensors.size(); i++) {
+        changed = changed || s.sensors[i].temperature != written.sensors[i].temperature
+          || s.sensors[i].lighting != written.sensors[i].lighting;
+    }
+    if (!changed) {
+        return;
+    }
+    Planner::record(written, s, journal);
+    written = s;
+}
+
+const WarehouseSnapshot&
+SensorStream::snapshot(void) const {
+    return s;
+}
+
+const SlotIndex&
+SensorStream::slotIndex(const WarehouseSnapshot& current) {
+    if (slots == NULL) {
+        slots = new SlotIndex(current);
+    } else {
+        slots->sync(current);
+    }
+    return *slots;
+}
+
+void
+SensorStream::invalidate(void) {
+    stale = true;
+}
@@ -0,0 +1,113 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main author:
+ *     Michael Brendle <michaelbrendle@me.com>
+ *
+ */
+
+#ifndef __WAREHOUSE_SENSORSTREAM_HH__
+#define __WAREHOUSE_SENSORSTREAM_HH__
+
+#include "planner.hh"
+#include "fitmatrix.hh"
+#include "slotindex.hh"
+
+#include <vector>
+
+/* -------------------------------
+ *  SENSOR STREAM
+ *
+ *  Live readings of the sensors, e.g. {"job":"sensor","id":2,
+ *  "temperature":21,"lighting":110} on a line of the resident planner.
+ *  The last readings of each sensor are kept in a ring buffer, and the
+ *  rolling mean is the value of the sensor. If it changes, only the
+ *  column of the fit matrix, the places of this sensor in the slot index
+ *  and the penalties of the goods at these places are recomputed. A good that leaves or reenters its
+ *  range is reported in an alert.
+ *  -------------------------------
+ */
+
+/// Number of readings of a sensor in the rolling aggregates.
+const int sensorWindow = 8;
+
+/// The last readings of one sensor.
+class SensorWindow {
+protected:
+  int temps[sensorWindow];
+  int lights[sensorWindow];
+  /// Next slot of the ring buffer and number of readings in it.
+  int head;
+  int count;
+  /// Sums of the readings in the ring buffer.
+  long tempSum;
+  long lightSum;
+public:
+  SensorWindow(void);
+  /// Adds a reading, the oldest one drops out of a full window.
+  void push(int temperature, int lighting);
+  bool empty(void) const;
+  /// Rolling means, rounded.
+  int temperature(void) const;
+  int lighting(void) const;
+  /// Mean, minimum and maximum of the temperature and the light.
+  Json::Value json(void) const;
+};
+
+class SensorStream {
+protected:
+  /// Penalty of a good that is not at a fitting Warehouse place.
+  int penalty;
+  /// Journal of the state, in which the sensor values are recorded.
+  StateJournal& journal;
+  /// Windows of the sensors (id 1, 2, ...).
+  std::vector<SensorWindow> windows;
+
+  /// State with the current sensor values, and as it was last written.
+  WarehouseSnapshot s;
+  WarehouseSnapshot written;
+  /// The state files have changed since they were read.
+  bool stale;
+
+  /// Fit of the goods of s.
+  FitMatrix* fit;
+  /// Warehouse places by temperature, with the current sensor values. It
+  /// is kept, when the state is read again.
+  SlotIndex* slots;
+  /// Warehouse place of each good, -1 for a garage place.
+  std::vector<int> placeOf;
+  /// Goods at the places of each sensor.
+  std::vector<std::vector<int> > goodsOf;
+  /// Penalty of each good and their sum.
+  std::vector<int> penalties;
+  int penaltyCost;
+
+  /// Reads the state and computes the fit matrix and the penalties.
+  void load(void);
+public:
+  SensorStream(int penalty, StateJournal& journal);
+  ~SensorStream(void);
+
+  /// Adds the reading \a reading. Returns the alert, or null, if no good
+  /// has left or reentered its range:
+  ///
+  ///   {"sensor":2,"temperature":{"mean":..,"min":..,"max":..},
+  ///    "lighting":{..},"goods":[{"name":..,"x_coord":..,"y_coord":..,
+  ///    "inRange":false}],"penaltyCost":..}
+  ///
+  /// An alert is recorded in the journal at once.
+  Json::Value ingest(const Json::Value& reading);
+  /// Records the changed sensor values in the journal, so that the next
+  /// job is planned with them.
+  void flush(void);
+  /// State with the current sensor values, after a reading.
+  const WarehouseSnapshot& snapshot(void) const;
+  /// Slot index of the state \a current, e.g. the state of a job. Only
+  /// the places of the sensors that changed since the last reading are
+  /// moved (see SlotIndex::sync).
+  const SlotIndex& slotIndex(const WarehouseSnapshot& current);
+  /// The state files were changed by a job: they are read again with the
+  /// next reading.
+  void invalidate(void);
+};
+
+#endif
@@ -0,0 +1,102 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main author:
+ *     Michael Brendle <michaelbrendle@me.com>
+ *
+ */
+
+#include "slotindex.hh"
+#include "inventory.hh"
+
+#include <climits>
+
+using namespace std;
+
+/// Sensor of each position of \a s, 0 for none.
+static void sensorPositions(const WarehouseSnapshot& s, int sensorAt[49]) {
+    for (int p = 0; p < 49; p++) {
+        sensorAt[p] = 0;
+    }
+    for (unsigned int i = 0; i < s.sections.size(); i++) {
+        if (s.sections[i].position >= 0 && s.sections[i].position < 49) {
+            sensorAt[s.sections[i].position] = s.sections[i].sensor;
+        }
+    }
+}
+
+SlotIndex::SlotIndex(const WarehouseSnapshot& s) {
+    int sensorAt[49];
+    sensorPositions(s, sensorAt);
+    for (unsigned int j = 0; j < s.warehousePosition.size(); j++) {
+        int position = s.warehousePosition[j];
+        positions.push_back(position);
+        temps.push_back(s.warehouseTemp[j]);
+        lights.push_back(s.warehouseLight[j]);
+        sensors.push_back(position >= 0 && position < 49 ? sensorAt[position] : 0);
+        byTemp.insert(make_pair(s.warehouseTemp[j], (int) j));
+    }
+}
+
+void
+SlotIndex::move(int j, int temperature, int lighting) {
+    byTemp.erase(make_pair(temps[j], j));
+    temps[j] = temperature;
+    lights[j] = lighting;
+    byTemp.insert(make_pair(temperature, j));
+}
+
+void
+SlotIndex::update(int sensor, int temperature, int lighting) {
+    for (unsigned int j = 0; j < positions.size(); j++) {
+        if (sensors[j] == sensor) {
+            move(j, temperature, lighting);
+        }
+    }
+}
+
+void
+SlotIndex::sync(const WarehouseSnapshot& s) {
+    int sensorAt[49];
+    sensorPositions(s, sensorAt);
+    bool same = positions.size() == s.warehousePosition.size();
+    for (unsigned int j = 0; j < positions.size() && same; j++) {
+        int position = s.warehousePosition[j];
+        same = positions[j] == position
+          && sensors[j] == (position >= 0 && position < 49 ? sensorAt[position] : 0);
+    }
+    if (!same) {
+        *this = SlotIndex(s);
+        return;
+    }
+    for (unsigned int j = 0; j < positions.size(); j++) {
+        if (temps[j] != s.warehouseTemp[j] || lights[j] != s.warehouseLight[j]) {
+            move(j, s.warehouseTemp[j], s.warehouseLight[j]);
+        }
+    }
+}
+
+vector<int>
+SlotIndex::compatible(const WarehouseGood& good) const {
+    vector<int> slots;
+    set<pair<int,int> >::const_iterator it = byTemp.lower_bound(make_pair(good.tempMin, INT_MIN));
+    set<pair<int,int> >::const_iterator end = byTemp.upper_bound(make_pair(good.tempMax, INT_MAX));
+    for (; it != end; ++it) {
+        int j = it->second;
+        if (good.lightMin <= lights[j] && lights[j] <= good.lightMax) {
+            slots.push_back(positions[j]);
+        }
+    }
+    return slots;
+}
+
+vector<int>
+SlotIndex::compatibleFree(const WarehouseGood& good, const Inventory& inventory) const {
+    vector<int> slots = compatible(good);
+    vector<int> free;
+    for (unsigned int k = 0; k < slots.size(); k++) {
+        if (!inventory.occupied(slots[k])) {
+            free.push_back(slots[k]);
+        }
+    }
+    return free;
+}
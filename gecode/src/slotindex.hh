@@ -0,0 +1,60 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main author:
+ *     Michael Brendle <michaelbrendle@me.com>
+ *
+ */
+
+#ifndef __WAREHOUSE_SLOTINDEX_HH__
+#define __WAREHOUSE_SLOTINDEX_HH__
+
+#include "planner.hh"
+
+#include <set>
+#include <utility>
+#include <vector>
+
+class Inventory;
+
+/* -------------------------------
+ *  SLOT INDEX
+ *
+ *  The Warehouse places ordered by the temperature of their sensor. The
+ *  places that fit a good are found by a binary search for its
+ *  temperature range, only these places are checked for its light range.
+ *  -------------------------------
+ */
+
+class SlotIndex {
+protected:
+  /// (temperature, index of the Warehouse place)
+  std::set<std::pair<int,int> > byTemp;
+  /// Position, sensor, temperature and light of each Warehouse place.
+  std::vector<int> positions;
+  std::vector<int> sensors;
+  std::vector<int> temps;
+  std::vector<int> lights;
+
+  /// Sets the values of the Warehouse place \a j in O(log n).
+  void move(int j, int temperature, int lighting);
+public:
+  /// Index of the Warehouse places of \a s.
+  SlotIndex(const WarehouseSnapshot& s);
+
+  /// Sets the values of the sensor \a sensor (1, 2, ...) for all its
+  /// places. Each place is moved in O(log n).
+  void update(int sensor, int temperature, int lighting);
+  /// Brings the index to the sensor values of \a s. Only the places of
+  /// the changed sensors are moved; the index is built again, if the
+  /// Warehouse places of \a s are other ones.
+  void sync(const WarehouseSnapshot& s);
+
+  /// Positions of the Warehouse places that fit \a good.
+  std::vector<int> compatible(const WarehouseGood& good) const;
+  /// Positions of the free Warehouse places of \a inventory that fit
+  /// \a good.
+  std::vector<int> compatibleFree(const WarehouseGood& good,
+                                  const Inventory& inventory) const;
+};
+
+#endif
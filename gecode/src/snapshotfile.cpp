@@ -0,0 +1,285 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main author:
+ *     Michael Brendle <michaelbrendle@me.com>
+ *
+ */
+
+#include "snapshotfile.hh"
+#include "jsonencoder.hh"
+#include "planner.hh"
+
+#include <cstring>
+
+#include <sys/stat.h>
+
+using namespace std;
+
+/* -------------------------------
+ *  FILE STAMP
+ *  -------------------------------
+ */
+
+FileStamp
+FileStamp::of(const string& file) {
+    FileStamp s;
+    memset(&s, 0, sizeof(s));
+    struct stat st;
+    if (stat(file.c_str(), &st) == 0) {
+        s.mtime = st.st_mtime;
+#ifdef __APPLE__
+        s.mtimeNsec = st.st_mtimespec.tv_nsec;
+#else
+        s.mtimeNsec = st.st_mtim.tv_nsec;
+#endif
+        s.size = st.st_size;
+        s.inode = st.st_ino;
+    }
+    return s;
+}
+
+bool
+FileStamp::operator ==(const FileStamp& s) const {
+    return mtime == s.mtime && mtimeNsec == s.mtimeNsec
+      && size == s.size && inode == s.inode;
+}
+
+
+
+
+/* -------------------------------
+ *  SNAPSHOT VIEW
+ *  -------------------------------
+ */
+
+/// Returns true, if the string \a s lies within a string table of \a size
+/// bytes. The check cannot overflow.
+static bool stringFits(const SnapshotString& s, uint32_t size) {
+    return s.offset <= size && s.length <= size - s.offset;
+}
+
+SnapshotView::SnapshotView(const string& file0)
+  : file(file0), header(NULL), robots(NULL), sensors(NULL),
+    sections(NULL), strings(NULL) {
+    if (file.size() < sizeof(SnapshotHeader)) {
+        return;
+    }
+    const SnapshotHeader* h = reinterpret_cast<const SnapshotHeader*>(file.data());
+    if (memcmp(h->magic, "GSDS", 4) != 0 || h->version != snapshotVersion) {
+        return;
+    }
+    size_t size = sizeof(SnapshotHeader)
+      + h->numRobots * sizeof(SnapshotRobot)
+      + h->numSensors * sizeof(SnapshotSensor)
+      + h->numSections * sizeof(SnapshotSection)
+      + h->stringsSize;
+    if (file.size() != size) {
+        return;
+    }
+    const SnapshotRobot* r = reinterpret_cast<const SnapshotRobot*>(h + 1);
+    const SnapshotSensor* t = reinterpret_cast<const SnapshotSensor*>(r + h->numRobots);
+    const SnapshotSection* b = reinterpret_cast<const SnapshotSection*>(t + h->numSensors);
+
+    // A corrupt file is not read: each section of the index and each
+    // string must lie within its table, so that the accessors need no
+    // checks.
+    for (int p = 0; p < 49; p++) {
+        if (h->sectionAt[p] < -1 || h->sectionAt[p] >= (int64_t) h->numSections) {
+            return;
+        }
+    }
+    for (unsigned int i = 0; i < h->numSections; i++) {
+        if (!stringFits(b[i].dock, h->stringsSize) || !stringFits(b[i].name, h->stringsSize)
+            || !stringFits(b[i].text, h->stringsSize)) {
+            return;
+        }
+    }
+
+    header = h;
+    robots = r;
+    sensors = t;
+    sections = b;
+    strings = reinterpret_cast<const char*>(sections + header->numSections);
+}
+
+bool
+SnapshotView::valid(void) const {
+    return header != NULL;
+}
+
+const FileStamp*
+SnapshotView::sources(void) const {
+    return header->sources;
+}
+
+bool
+SnapshotView::current(const string& robotFile, const string& sensorsFile,
+                      const string& sectionsFile) const {
+    return header->sources[0] == FileStamp::of(robotFile)
+      && header->sources[1] == FileStamp::of(sensorsFile)
+      && header->sources[2] == FileStamp::of(sectionsFile);
+}
+
+unsigned int
+SnapshotView::numRobots(void) const {
+    return header->numRobots;
+}
+
+unsigned int
+SnapshotView::numSensors(void) const {
+    return header->numSensors;
+}
+
+unsigned int
+SnapshotView::numSections(void) const {
+    return header->numSections;
+}
+
+const SnapshotRobot&
+SnapshotView::robot(unsigned int r) const {
+    return robots[r];
+}
+
+const SnapshotSensor&
+SnapshotView::sensor(unsigned int i) const {
+    return sensors[i];
+}
+
+const SnapshotSection&
+SnapshotView::section(unsigned int i) const {
+    return sections[i];
+}
+
+const SnapshotSection*
+SnapshotView::sectionAt(int position) const {
+    if (position < 0 || position >= 49 || header->sectionAt[position] < 0) {
+        return NULL;
+    }
+    return &sections[header->sectionAt[position]];
+}
+
+string
+SnapshotView::str(const SnapshotString& s) const {
+    return std::string(strings + s.offset, s.length);
+}
+
+WarehouseSnapshot
+SnapshotView::snapshot(void) const {
+    WarehouseSnapshot s;
+    s.robotArray = header->robotArray != 0;
+    s.journalSeq = s.snapshotSeq = header->journalSeq;
+    for (unsigned int r = 0; r < header->numRobots; r++) {
+        WarehouseRobot robot;
+        robot.position = robots[r].position;
+        robot.orientation = robots[r].orientation;
+        robot.backward = robots[r].backward != 0;
+        s.robots.push_back(robot);
+    }
+    for (unsigned int i = 0; i < header->numSensors; i++) {
+        WarehouseSensor sensor;
+        sensor.id = sensors[i].id;
+        sensor.temperature = sensors[i].temperature;
+        sensor.lighting = sensors[i].lighting;
+        s.sensors.push_back(sensor);
+    }
+    for (unsigned int i = 0; i < header->numSections; i++) {
+        const SnapshotSection& b = sections[i];
+        WarehouseSection section;
+        section.position = b.position;
+        section.sensor = b.sensor;
+        section.dock = str(b.dock);
+        section.occupied = b.occupied != 0;
+        section.good.name = str(b.name);
+        section.good.position = b.position;
+        section.good.tempMin = b.tempMin;
+        section.good.tempMax = b.tempMax;
+        section.good.lightMin = b.lightMin;
+        section.good.lightMax = b.lightMax;
+        section.text = str(b.text);
+        s.sections.push_back(section);
+    }
+    return s;
+}
+
+
+
+
+/* -------------------------------
+ *  WRITING THE SNAPSHOT
+ *  -------------------------------
+ */
+
+/// Appends \a s to the string table \a strings.
+static SnapshotString addString(std::string& strings, const std::string& s) {
+    SnapshotString r;
+    r.offset = strings.size();
+    r.length = s.size();
+    strings += s;
+    return r;
+}
+
+bool
+WarehouseSnapshot::writeBinary(const string& snapshotFile, const string& robotFile,
+                               const string& sensorsFile, const string& sectionsFile) const {
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "GSDS", 4);
+    header.version = snapshotVersion;
+    header.numRobots = robots.size();
+    header.robotArray = robotArray;
+    header.numSensors = sensors.size();
+    header.numSections = sections.size();
+    header.journalSeq = journalSeq;
+    header.sources[0] = FileStamp::of(robotFile);
+    header.sources[1] = FileStamp::of(sensorsFile);
+    header.sources[2] = FileStamp::of(sectionsFile);
+    for (int p = 0; p < 49; p++) {
+        header.sectionAt[p] = -1;
+    }
+
+    vector<SnapshotSection> table(sections.size());
+    std::string strings;
+    for (unsigned int i = 0; i < sections.size(); i++) {
+        const WarehouseSection& section = sections[i];
+        SnapshotSection& b = table[i];
+        memset(&b, 0, sizeof(b));
+        b.position = section.position;
+        b.sensor = section.sensor;
+        b.occupied = section.occupied;
+        b.tempMin = section.good.tempMin;
+        b.tempMax = section.good.tempMax;
+        b.lightMin = section.good.lightMin;
+        b.lightMax = section.good.lightMax;
+        b.dock = addString(strings, section.dock);
+        b.name = addString(strings, section.good.name);
+        b.text = addString(strings, section.text);
+        if (section.position >= 0 && section.position < 49) {
+            header.sectionAt[section.position] = i;
+        }
+    }
+    header.stringsSize = strings.size();
+
+    AtomicFile file(snapshotFile);
+    std::ostream& out = file.stream();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (unsigned int r = 0; r < robots.size(); r++) {
+        SnapshotRobot b;
+        b.position = robots[r].position;
+        b.orientation = robots[r].orientation;
+        b.backward = robots[r].backward;
+        out.write(reinterpret_cast<const char*>(&b), sizeof(b));
+    }
+    for (unsigned int i = 0; i < sensors.size(); i++) {
+        SnapshotSensor b;
+        b.id = sensors[i].id;
+        b.temperature = sensors[i].temperature;
+        b.lighting = sensors[i].lighting;
+        out.write(reinterpret_cast<const char*>(&b), sizeof(b));
+    }
+    if (!table.empty()) {
+        out.write(reinterpret_cast<const char*>(&table[0]),
+                  table.size() * sizeof(SnapshotSection));
+    }
+    out.write(strings.data(), strings.size());
+    return file.commit();
+}
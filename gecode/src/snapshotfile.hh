@@ -0,0 +1,151 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main author:
+ *     Michael Brendle <michaelbrendle@me.com>
+ *
+ */
+
+#ifndef __WAREHOUSE_SNAPSHOTFILE_HH__
+#define __WAREHOUSE_SNAPSHOTFILE_HH__
+
+#include "jsondecoder.hh"
+
+#include <stdint.h>
+#include <string>
+
+class WarehouseSnapshot;
+
+/* -------------------------------
+ *  BINARY SNAPSHOT FILE
+ *
+ *  The state of the Warehouse in a fixed layout, which is mapped into
+ *  memory and decoded without parsing:
+ *
+ *    SnapshotHeader
+ *    SnapshotRobot[numRobots]
+ *    SnapshotSensor[numSensors]
+ *    SnapshotSection[numSections]
+ *    char[stringsSize]            (names, docks and section texts)
+ *
+ *  The planner copies the state once into a WarehouseSnapshot, on which
+ *  it replays the journal (see WarehouseSnapshot::read). The view itself
+ *  is not the current state, since the changes after the snapshot are
+ *  only in the journal.
+ *
+ *  The JSON files robot.js, sensors.js and sections.js are the export of
+ *  the same state, for the web server and tools. The header holds their
+ *  stamps: if the web server changes a JSON file, the changes of the file
+ *  are imported again. The changes after the snapshot are in the journal
+ *  (see StateJournal), the JSON files are exported again with the next
+ *  snapshot file.
+ *  -------------------------------
+ */
+
+/// Modification time, size and inode of a file. An atomic replace always
+/// changes the inode.
+struct FileStamp {
+  int64_t mtime;
+  int64_t mtimeNsec;
+  int64_t size;
+  int64_t inode;
+
+  /// Stamp of \a file, all zero, if the file does not exist.
+  static FileStamp of(const std::string& file);
+  bool operator ==(const FileStamp& s) const;
+};
+
+/// A string in the string table.
+struct SnapshotString {
+  uint32_t offset;
+  uint32_t length;
+};
+
+struct SnapshotHeader {
+  /// "GSDS"
+  char magic[4];
+  uint32_t version;
+  uint32_t numRobots;
+  uint32_t robotArray;
+  uint32_t numSensors;
+  uint32_t numSections;
+  uint32_t stringsSize;
+  /// Number of the last change of the journal in the snapshot (see
+  /// StateJournal).
+  uint32_t journalSeq;
+  /// Stamps of robot.js, sensors.js and sections.js.
+  FileStamp sources[3];
+  /// Index of the section at each position, -1 for no section.
+  int32_t sectionAt[49];
+};
+
+struct SnapshotRobot {
+  int32_t position;
+  int32_t orientation;
+  int32_t backward;
+};
+
+struct SnapshotSensor {
+  int32_t id;
+  int32_t temperature;
+  int32_t lighting;
+};
+
+struct SnapshotSection {
+  int32_t position;
+  int32_t sensor;
+  int32_t occupied;
+  int32_t tempMin;
+  int32_t tempMax;
+  int32_t lightMin;
+  int32_t lightMax;
+  SnapshotString dock;
+  SnapshotString name;
+  /// JSON text of the section (see WarehouseSection), so that the export
+  /// to sections.js is lossless.
+  SnapshotString text;
+};
+
+/// Version of the layout. A file of another version is not read.
+const uint32_t snapshotVersion = 2;
+
+/// A binary snapshot file mapped into memory. The accessors read in
+/// place; the constructor checks the tables and the string offsets, so a
+/// corrupt file is not valid.
+class SnapshotView {
+protected:
+  MappedFile file;
+  const SnapshotHeader* header;
+  const SnapshotRobot* robots;
+  const SnapshotSensor* sensors;
+  const SnapshotSection* sections;
+  const char* strings;
+public:
+  SnapshotView(const std::string& file);
+
+  /// Returns true, if the file is a complete snapshot of this version.
+  bool valid(void) const;
+  /// Stamps of robot.js, sensors.js and sections.js.
+  const FileStamp* sources(void) const;
+  /// Returns true, if the JSON files were not changed since the snapshot
+  /// was written.
+  bool current(const std::string& robotFile, const std::string& sensorsFile,
+               const std::string& sectionsFile) const;
+
+  unsigned int numRobots(void) const;
+  unsigned int numSensors(void) const;
+  unsigned int numSections(void) const;
+  const SnapshotRobot& robot(unsigned int r) const;
+  const SnapshotSensor& sensor(unsigned int i) const;
+  const SnapshotSection& section(unsigned int i) const;
+  /// Section at \a position, or NULL, if there is none.
+  const SnapshotSection* sectionAt(int position) const;
+  /// A string of the string table of the file.
+  std::string str(const SnapshotString& s) const;
+
+  /// Copies the robots, the sensors and the sections into the structs of
+  /// the planner. The snapshot is not classified yet (see
+  /// WarehouseSnapshot::classify), since the journal is replayed first.
+  WarehouseSnapshot snapshot(void) const;
+};
+
+#endif
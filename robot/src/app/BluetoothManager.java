@@ -3,6 +3,8 @@ package app;
 import java.io.DataInputStream;
 import java.io.DataOutputStream;
 import java.io.IOException;
+import java.util.ArrayList;
+import java.util.Arrays;
 
 
 import lejos.hardware.Bluetooth;
@@ -13,9 +15,21 @@ import lejos.remote.nxt.NXTConnection;
 import lejos.remote.nxt.RemoteNXT;
 
 public class BluetoothManager extends Thread{
+	//First byte of a binary frame of instructions
+	public static final int FRAME_START = 0xB5;
+	//Result of a binary frame, it is reported back (FRAME:OK, FRAME:CRC or
+	//FRAME:INVALID), so that the web server sends a damaged frame again
+	public static final int FRAME_OK = 0;
+	public static final int FRAME_CRC = 1;
+	public static final int FRAME_INVALID = 2;
+	public static final String[] FRAME_REPLIES = {"FRAME:OK\n", "FRAME:CRC\n", "FRAME:INVALID\n"};
+	//Received bytes, that are no complete frame or line yet
+	private byte[] pending = new byte[512];
+	private int pendingSize = 0;
 	public Bluetooth bt;
 	public BTConnector btc;
 	public NXTConnection connection;
+	public DataOutputStream dou;
 	public Walker walker;
 	public BluetoothManager(Walker walker){
 		this.walker = walker;
@@ -23,8 +37,15 @@ public class BluetoothManager extends Thread{
 	public void Parse(String str){
 		//Style: INSTRUCTIONS:FORWARD,2;TURN,1,LEFT
 		String[] set = str.split(":");
-		String key = set[0];
+		if(set.length<2) return;
+		String key = set[0].trim();
 		String content = set[1];
+		//Style: GO:3 (the SYNC,3 of all robots is reached)
+		if(key.equals("GO")){
+			try{
+				walker.released = Integer.parseInt(content.trim().split("\n")[0].trim());
+			}catch(Exception e){}
+		}
 		if(key.equals("INSTRUCTIONS")){
 			String[] ins = content.split(";");
 			for(String i:ins){
@@ -48,22 +69,128 @@ public class BluetoothManager extends Thread{
 			}
 		}
 	}
+	//Style: 0xB5, length, instructions, CRC-8 of length and instructions
+	//An instruction is one byte: movement (bits 7-5, as MOVEMENT), value
+	//(bits 4-1, 0 if it is in the next byte) and the flag (bit 0, RIGHT of a
+	//TURN, the left sensor of a FORWARD). See instructioncodec.hh of the planner.
+	//The instructions are only taken, if the whole frame is valid.
+	public int ParseFrame(byte[] b, int offset, int end){
+		if(end-offset<3) return FRAME_INVALID;
+		int length = b[offset+1] & 0xFF;
+		int last = offset+2+length;
+		if(end<=last) return FRAME_INVALID;
+		if(crc8(b, offset+1, last)!=(b[last] & 0xFF)) return FRAME_CRC;
+		ArrayList<Instruction> decoded = new ArrayList<Instruction>();
+		for(int k=offset+2;k<last;k++){
+			int code = b[k] & 0xFF;
+			int value = (code>>1) & 15;
+			if((code>>5)>=Instruction.MOVEMENT.values().length) return FRAME_INVALID;
+			if(value==0){
+				if(++k==last) return FRAME_INVALID;
+				value = b[k] & 0xFF;
+			}
+			Instruction.MOVEMENT movement = Instruction.MOVEMENT.values()[code>>5];
+			if(movement==Instruction.MOVEMENT.TURN){
+				decoded.add(new Instruction(movement, value,
+						(code & 1)==1 ? Instruction.DIRECTION.RIGHT : Instruction.DIRECTION.LEFT));
+			}else{
+				decoded.add(new Instruction(movement, value));
+			}
+		}
+		walker.instructions.addAll(decoded);
+		return FRAME_OK;
+	}
+	//Adds n received bytes to the pending bytes
+	private void append(byte[] b, int n){
+		if(pendingSize+n>pending.length){
+			pending = Arrays.copyOf(pending, Math.max(2*pending.length, pendingSize+n));
+		}
+		System.arraycopy(b, 0, pending, pendingSize, n);
+		pendingSize += n;
+	}
+	//Parses the complete frames and lines of the pending bytes. A read may
+	//return a part of a frame or of a line: a frame is parsed, when all its
+	//length+3 bytes have arrived, a line at its end (\n). The rest waits
+	//for the next read.
+	public void parsePending() throws IOException{
+		int start = 0;
+		while(true){
+			while(start<pendingSize && pending[start]==' ') start++;
+			if(start==pendingSize) break;
+			if((pending[start] & 0xFF)==FRAME_START){
+				if(pendingSize-start<2) break;
+				int end = start+(pending[start+1] & 0xFF)+3;
+				if(pendingSize<end) break;
+				int result = ParseFrame(pending, start, end);
+				write(FRAME_REPLIES[result].getBytes());
+				if(result!=FRAME_OK){
+					//The length may be damaged, too: the rest is dropped
+					//and the frame comes again.
+					start = pendingSize;
+					break;
+				}
+				start = end;
+			}else{
+				int end = start;
+				while(end<pendingSize && pending[end]!='\n') end++;
+				if(end==pendingSize) break;
+				String line = new String(pending, start, end+1-start);
+				Parse(line);
+				write(line.getBytes());
+				start = end+1;
+			}
+		}
+		System.arraycopy(pending, start, pending, 0, pendingSize-start);
+		pendingSize -= start;
+	}
+	//CRC-8 with the polynomial 0x07
+	public static int crc8(byte[] b, int begin, int end){
+		int crc = 0;
+		for(int k=begin;k<end;k++){
+			crc ^= b[k] & 0xFF;
+			for(int bit=0;bit<8;bit++){
+				crc = (crc & 0x80)!=0 ? ((crc<<1) ^ 0x07) & 0xFF : (crc<<1) & 0xFF;
+			}
+		}
+		return crc;
+	}
+	//Style: SYNC:3 (the robot waits at SYNC,3)
+	public void sync(int t){
+		try {
+			write(("SYNC:"+t+"\n").getBytes());
+		} catch (IOException e) {
+			System.out.println("ERROR");
+		}
+	}
+	//Style: TIMING:FORWARD,2,1830 (instruction, value and duration in ms)
+	public void report(Instruction instruction, long millis){
+		try {
+			write(("TIMING:"+instruction.movement+","+instruction.duration+","+millis+"\n").getBytes());
+		} catch (IOException e) {
+			System.out.println("ERROR");
+		}
+	}
+	public synchronized void write(byte[] b) throws IOException{
+		if(dou==null) return;
+		dou.write(b);
+		dou.flush();
+	}
 	public void run(){
 		
 		NXTCommConnector cm = bt.getNXTCommConnector();
 		connection = cm.waitForConnection(100, 0);
 	    DataInputStream dis = connection.openDataInputStream();
-	    DataOutputStream dou = connection.openDataOutputStream();
+	    dou = connection.openDataOutputStream();
 
+	    byte[] b = new byte[200];
 	    while(true){
 	        try {
 	        	if(dis.available()>0){
-	        	byte[] b = new byte[200];
-				dis.read(b);
-				String n = new String(b);
-				Parse(n);
-				dou.write(b);
-				dou.flush();
+				int n = dis.read(b);
+				if(n>0){
+					append(b, n);
+					parsePending();
+				}
 			    //LCD.drawString("Data: "+n, 0, 0);
 	        	}
 			} catch (IOException e) {
@@ -2,7 +2,7 @@ package app;
 
 public class Instruction {
 	public enum MOVEMENT {
-	     FORWARD, BACKWARD, TURN, PICK, DROP
+	     FORWARD, BACKWARD, TURN, PICK, DROP, SYNC
 	}
 	public enum DIRECTION {
 	     RIGHT, LEFT
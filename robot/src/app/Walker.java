@@ -27,6 +27,11 @@ public class Walker extends Thread{
 	public boolean dropStarted=false;
 	public LineFollower lineFollower;
 	public Core core;
+	//Start of the current instruction in ms, -1 if it is not started yet
+	public long started=-1;
+	//SYNC point that the webserver released (GO:t), -1 for none
+	public volatile int released=-1;
+	public boolean syncReported=false;
 	public Walker(RegulatedMotor m1, RegulatedMotor m2, EV3ColorSensor colorSensor1, EV3ColorSensor colorSensor2, EV3UltrasonicSensor sonar, RegulatedMotor gripper,  ArrayList<Instruction> instructions, LineFollower lineFollower, Core core){
 		this.m1=m1;
 		this.m2=m2;
@@ -43,6 +48,9 @@ public class Walker extends Thread{
 		while(true){
 			if(!this.instructions.isEmpty()){
 				Instruction i = instructions.get(0);
+				if(started<0){
+					started=System.currentTimeMillis();
+				}
 			    LCD.drawString(counter+"", 0, 0);
 			    if(i.movement==Instruction.MOVEMENT.DROP){
 			    	if(!dropStarted){
@@ -125,6 +133,24 @@ public class Walker extends Thread{
 						nextInstruction();
 					}
 				}
+				//Wait at SYNC,t until the webserver releases it, when all
+				//robots have reached it
+				if(i.movement==Instruction.MOVEMENT.SYNC){
+					m1.stop(true);
+					m2.stop(true);
+					if(Core.bluetooth==null){
+						released=i.duration;
+					}else if(!syncReported){
+						Core.bluetooth.sync(i.duration);
+						syncReported=true;
+					}
+					if(released==i.duration){
+						released=-1;
+						syncReported=false;
+						instructions.remove(0);
+						started=-1;
+					}
+				}
 				if(i.movement==Instruction.MOVEMENT.TURN){
 					m1.stop(true);
 					m2.stop(true);
@@ -164,7 +190,12 @@ public class Walker extends Thread{
 		}
 	}
 	public void nextInstruction(){
-		instructions.remove(0);
+		Instruction i = instructions.remove(0);
+		//Report the duration for the calibration of the planner
+		if(Core.bluetooth!=null){
+			Core.bluetooth.report(i, System.currentTimeMillis()-started);
+		}
+		started=-1;
 		counter=0;
 	}
 	public void controlDots(){
@@ -1,44 +1,352 @@
 var express = require('express');
 var app = express();
 var gecodeRunning = false;
+var idleRunning = false;
+// An urgent order stopped the running search, the next order is sent as
+// soon as the planner answers.
+var urgentPending = false;
+// Maximal number of queued orders that are planned together in one run.
+var batchSize = 3;
+// Number of queued orders that are reordered by the sequencer.
+var sequenceWindow = 8;
+// Maximal number of positions an order without an own deadline can be
+// delayed by the sequencer (as sequenceMaxDelay of the planner). The bound
+// is stored as the deadline of the order, when it is queued, so that it
+// shrinks with the queue and the order cannot be delayed forever.
+var sequenceMaxDelay = 3;
+// Number of recent orders, from which the planner takes the position of an
+// idle robot (pre-positioning).
+var historySize = 50;
+// Bluetooth addresses of the robots. The planner plans all robots together
+// in common steps, the robots wait for each other between the steps (see
+// releaseSyncs).
+var robotAddresses = ["00-16-53-4b-c6-7b"];
+// Encoding of the instructions for the robots: 'text' or 'binary' (one or
+// two bytes per instruction in a frame with a checksum, see
+// instructioncodec.hh of the planner).
+var instructionEncoding = 'text';
 var fs = require('fs');
-var robotOrigin = '{"backward" : true,"orientation" : 0,"x_coord" : 0,"y_coord" : 0}'
-fs.writeFile('./robot.js', robotOrigin, function (err) {
+// A single robot is stored as an object, several robots as an array. The
+// robot k starts at (k,0).
+var robotOrigin = robotAddresses.map(function (address, k) {
+	return {"backward" : true,"orientation" : 0,"x_coord" : k,"y_coord" : 0};
+});
+fs.writeFile('./robot.js', JSON.stringify(robotOrigin.length == 1 ? robotOrigin[0] : robotOrigin), function (err) {
 	if (err) return console.log(err);
-	console.log('The robot is reset (0,0)');
+	console.log('The robots are reset (0,0)');
 });
 
-var btSerial = new (require('bluetooth-serial-port')).BluetoothSerialPort();
-btSerial.connect("00-16-53-4b-c6-7b", 1, function() {
-    console.log('Connected with Robot via Bluetooth');
-    btSerial.on('data', function(buffer) {
-        console.log(buffer.toString());
-    });
-}, function () {
-    console.log('cannot connect');
+// The robots report the duration of each executed instruction
+// (TIMING:FORWARD,2,1830). They are logged to ./timings.log, from which
+// calibrate.js fits the durations for the planner.
+function logTimings(k, text){
+	text.split('\n').forEach(function (line) {
+		var timing = /TIMING:(\w+),(-?\d+),(\d+)/.exec(line);
+		if (timing == null) return;
+		var entry = {"robot":k,"instruction":timing[1],"value":parseInt(timing[2]),"ms":parseInt(timing[3])};
+		fs.appendFile('./timings.log', JSON.stringify(entry) + '\n', function (err) {
+			if (err) console.log(err);
+		});
+	});
+};
+
+// With several robots, each robot stops at SYNC,t of its instructions and
+// reports SYNC:t. It gets GO:t, when all robots have reached a SYNC of at
+// least t, so no robot starts the step t before all robots have finished
+// the steps before it.
+var syncReached = robotAddresses.map(function () { return Infinity; });
+var syncWaiting = robotAddresses.map(function () { return -1; });
+
+function logSyncs(k, text){
+	text.split('\n').forEach(function (line) {
+		var sync = /SYNC:(\d+)/.exec(line);
+		if (sync == null) return;
+		syncReached[k] = parseInt(sync[1]);
+		syncWaiting[k] = parseInt(sync[1]);
+	});
+	releaseSyncs();
+};
+
+function releaseSyncs(){
+	var reached = Math.min.apply(null, syncReached);
+	syncWaiting.forEach(function (t, k) {
+		if (t < 0 || t > reached) return;
+		syncWaiting[k] = -1;
+		btSerials[k].write(new Buffer('  GO:' + t + '\n', 'utf-8'), function (err) {
+			if (err) console.log(err);
+		});
+	});
+};
+
+// A robot reports each binary frame with FRAME:OK, FRAME:CRC or
+// FRAME:INVALID. A damaged frame is sent again, up to frameRetries times.
+var frameRetries = 3;
+var sentFrames = robotAddresses.map(function () { return null; });
+
+function resendFrames(k, text){
+	text.split('\n').forEach(function (line) {
+		var frame = /FRAME:(\w+)/.exec(line);
+		if (frame == null || sentFrames[k] == null) return;
+		if (frame[1] == 'OK' || sentFrames[k].retries >= frameRetries) {
+			if (frame[1] != 'OK') console.log('Robot ' + k + ' rejected the frame: ' + frame[1]);
+			sentFrames[k] = null;
+			return;
+		}
+		sentFrames[k].retries++;
+		btSerials[k].write(sentFrames[k].buffer, function (err) {
+			if (err) console.log(err);
+		});
+	});
+};
+
+var btSerials = robotAddresses.map(function (address, k) {
+	var btSerial = new (require('bluetooth-serial-port')).BluetoothSerialPort();
+	var received = '';
+	btSerial.connect(address, 1, function() {
+	    console.log('Connected with Robot ' + k + ' via Bluetooth');
+	    btSerial.on('data', function(buffer) {
+	        console.log(buffer.toString());
+	        received += buffer.toString();
+	        var end = received.lastIndexOf('\n');
+	        if (end >= 0) {
+	            logTimings(k, received.substring(0, end));
+	            logSyncs(k, received.substring(0, end));
+	            resendFrames(k, received.substring(0, end));
+	            received = received.substring(end + 1);
+	        }
+	    });
+	}, function () {
+	    console.log('cannot connect to Robot ' + k);
+	});
+	return btSerial;
 });
 
+// Sends the instructions of the planner to the robots. The instructions of
+// the robots are separated by '|'. Binary instructions (FRAMES:) come as one
+// hex frame per robot and are sent as they are.
+function sendToRobots(stdout){
+	var binary = stdout.substring(0,7) == 'FRAMES:';
+	var instructions = stdout.replace(/^(INSTRUCTIONS|FRAMES):/, '').split('|');
+	btSerials.forEach(function (btSerial, k) {
+		// A robot without instructions does not hold up the others.
+		syncReached[k] = instructions[k] != undefined ? 0 : Infinity;
+		syncWaiting[k] = -1;
+		var buffer;
+		if (binary && instructions[k] != undefined) {
+			buffer = Buffer.concat([new Buffer('  ', 'utf-8'), new Buffer(instructions[k], 'hex')]);
+		} else {
+			var line = 'INSTRUCTIONS:' + (binary || instructions[k] == undefined ? '' : instructions[k]);
+			buffer = new Buffer('  '+line+'\n', 'utf-8');
+		}
+		sentFrames[k] = binary && instructions[k] != undefined ? {"buffer": buffer, "retries": 0} : null;
+		btSerial.write(buffer, function(err, bytesWritten) {
+			console.log(bytesWritten)
+			if (err) console.log(err);
+		});
+	});
+};
+
 
 
 app.use('/static', express.static('public'));
 
 
+// Locations of the recent orders: the position of a move, the section of a
+// placeGood or remove, and the add zone of an add ({"job":"add"}).
+var orderHistory = [];
+try {
+	orderHistory = JSON.parse(fs.readFileSync('./history.js', 'utf8'));
+} catch (err) {}
+
+function recordOrder(order){
+	var location = order.job == "move" ? order.to : order.from;
+	if (order.job == "relocate") location = order.moves[0].from;
+	if (order.job == "add") {
+		orderHistory.push({"job":"add"});
+	} else {
+		orderHistory.push({"job":order.job,"x_coord":location.x_coord,"y_coord":location.y_coord});
+	}
+	orderHistory = orderHistory.slice(-historySize);
+	fs.writeFile('./history.js', JSON.stringify(orderHistory), function (err) {
+		if (err) return console.log(err);
+	});
+};
+
 app.get('/', function (req, res) {
 	res.sendfile('./index.html');
 });
 
+// The state is served by the planner. It only records the changes in its
+// journal, the JSON files are written from time to time.
 app.get('/db', function (req, res) {
-	res.sendfile('./sections.js');
+	readState(function (state) {
+		res.json(state.sections);
+	});
 });
 
 app.get('/sensors', function (req, res) {
-	res.sendfile('./sensors.js');
+	readState(function (state) {
+		res.json(state.sensors);
+	});
 });
 
 app.get('/robot', function (req, res) {
-	res.sendfile('./robot.js');
+	readState(function (state) {
+		res.json(state.robot);
+	});
 });
 
+// Reads the current state of the Warehouse from the planner: the sections,
+// the sensors and the robot, as in sections.js, sensors.js and robot.js.
+// The planner answers at once, also while it plans an order.
+function readState(callback){
+	if (planner == null) startPlanner();
+	stateCallbacks.push(callback);
+	planner.stdin.write('{"job":"state"}\n');
+};
+
+function emptyState(){
+	return {"sections": [], "sensors": [], "robot": {}};
+};
+
+function positionKey(coord){
+	return coord.x_coord + ',' + coord.y_coord;
+};
+
+// Checks, if all positions of an order are in the 7x7 grid of the Warehouse.
+function inWarehouse(order){
+	var coords = order.job == "relocate"
+		? [].concat.apply([], order.moves.map(function (move) { return [move.from, move.to]; }))
+		: [order.from, order.to].filter(function (coord) { return coord != undefined; });
+	return coords.every(function (coord) {
+		return /^[0-6]$/.test(String(coord.x_coord)) && /^[0-6]$/.test(String(coord.y_coord));
+	});
+};
+
+// Checks, if an order picks up or drops a good at the position.
+function touchesPosition(order, key){
+	if (order.job == "relocate") {
+		return order.moves.some(function (move) {
+			return positionKey(move.from) == key || positionKey(move.to) == key;
+		});
+	}
+	return (order.from != undefined && positionKey(order.from) == key)
+		|| (order.job != "move" && order.to != undefined && positionKey(order.to) == key);
+};
+
+function touchedAfter(obj, index, key){
+	for (var k = index + 1; k < obj.length; k++) {
+		if (touchesPosition(obj[k], key)) return true;
+	}
+	return false;
+};
+
+// Ingest of a new order: before the order is appended to the queue, it is
+// merged with or cancelled against the pending orders and the current
+// state, since every order costs a run of the planner and a trip of the
+// robot. Returns what was done for the log.
+//
+//  - A move right after a move of the same robot replaces it, only the
+//    last one counts.
+//  - A move to the current robot position with an empty queue is dropped.
+//  - A placeGood to the same position is dropped.
+//  - A placeGood or remove of a good, that a pending placeGood brings to
+//    this position, is merged into the pending placeGood (A->B, B->C is
+//    A->C; A->B, B->A cancels both; A->B, remove B is remove A).
+//  - A placeGood or remove from an empty section is dropped, and so is a
+//    relocate with a move from an empty section.
+//  - An order with a position outside of the Warehouse is dropped.
+function ingestOrder(obj, order, state){
+	var last = obj[obj.length-1];
+	if (order.deadline == undefined) {
+		order.deadline = obj.length + sequenceMaxDelay;
+	}
+
+	if (!inWarehouse(order)) {
+		return 'cancelled, a position is not in the Warehouse';
+	}
+
+	if (order.job == "relocate") {
+		var emptyMove = order.moves.filter(function (move) {
+			return !goodThere(obj, state, positionKey(move.from));
+		})[0];
+		if (emptyMove != undefined) {
+			return 'cancelled, there is no good at ' + positionKey(emptyMove.from);
+		}
+		obj.push(order);
+		return 'queued';
+	}
+
+	if (order.job == "move") {
+		var robot = order.robot != undefined ? order.robot : 0;
+		if (last != undefined && last.job == "move" && (last.robot != undefined ? last.robot : 0) == robot) {
+			if (last.deadline != undefined) {
+				order.deadline = Math.min(order.deadline, last.deadline);
+			}
+			obj[obj.length-1] = order;
+			return 'merged with the previous move';
+		}
+		var robotState = Array.isArray(state.robot) ? state.robot[robot] : state.robot;
+		if (last == undefined && robotState != undefined && positionKey(order.to) == positionKey(robotState)) {
+			return 'cancelled, the robot is already there';
+		}
+		obj.push(order);
+		return 'queued';
+	}
+
+	var from = positionKey(order.from);
+	if (order.job == "placeGood" && from == positionKey(order.to)) {
+		return 'cancelled, the good is already there';
+	}
+
+	// The last pending order that picks up or drops a good at this position.
+	var i = obj.length - 1;
+	while (i >= 0 && !touchesPosition(obj[i], from)) i--;
+
+	if (i >= 0 && obj[i].job == "placeGood" && positionKey(obj[i].to) == from
+		&& !touchedAfter(obj, i, positionKey(obj[i].from))
+		&& (order.job == "remove" || !touchedAfter(obj, i, positionKey(order.to)))) {
+		var previous = obj[i];
+		var merged;
+		if (order.job == "remove") {
+			merged = {"job":"remove","from":previous.from};
+		} else if (positionKey(previous.from) == positionKey(order.to)) {
+			obj.splice(i, 1);
+			return 'cancelled together with the pending placeGood';
+		} else {
+			merged = {"job":"placeGood","from":previous.from,"to":order.to};
+		}
+		if (previous.deadline != undefined || order.deadline != undefined) {
+			merged.deadline = Math.min(
+				previous.deadline != undefined ? previous.deadline : Infinity,
+				order.deadline != undefined ? order.deadline : Infinity);
+		}
+		obj[i] = merged;
+		return 'merged with the pending placeGood';
+	}
+
+	if (i < 0 && !goodThere(obj, state, from)) {
+		return 'cancelled, there is no good at ' + from;
+	}
+
+	obj.push(order);
+	return 'queued';
+};
+
+// Checks, if there may be a good at the position, when the order is
+// planned. Without a pending order at this position, the good must be
+// there now. An add order may bring a good to any free section, so then
+// we keep it.
+function goodThere(obj, state, key){
+	if (obj.some(function (o) { return o.job == "add" || touchesPosition(o, key); })) {
+		return true;
+	}
+	var section = state.sections.filter(function (s) {
+		return positionKey(s) == key;
+	})[0];
+	return section != undefined && section.status == "occupied";
+};
+
 app.get('/robot/:order/', function(req, res) {
 	var fs = require('fs');
 	var obj;
@@ -46,6 +354,7 @@ app.get('/robot/:order/', function(req, res) {
 	var to_yCoord;
 	var from_xCoord;
 	var from_yCoord;
+	var order;
 	firstOrder = true;
 
 	fs.readFile('./orders.js', 'utf8', function (err, data) {
@@ -57,23 +366,72 @@ app.get('/robot/:order/', function(req, res) {
 		if(stringOrder.substring(0,4) == "move"){
 			to_xCoord = stringOrder.substring(5,6);
 			to_yCoord = stringOrder.substring(7,8);
-			obj.push({"job":"move","to":{"x_coord":to_xCoord,"y_coord":to_yCoord}});
+			order = {"job":"move","to":{"x_coord":to_xCoord,"y_coord":to_yCoord}};
 
 		} if (stringOrder.substring(0,9) == "placeGood") {
 			from_xCoord = stringOrder.substring(10,11);
 			from_yCoord = stringOrder.substring(12,13);
 			to_xCoord = stringOrder.substring(15,16);
 			to_yCoord = stringOrder.substring(17,18);
-			obj.push({"job":"placeGood","from":{"x_coord":from_xCoord,"y_coord":from_yCoord},"to":{"x_coord":to_xCoord,"y_coord":to_yCoord}});
+			order = {"job":"placeGood","from":{"x_coord":from_xCoord,"y_coord":from_yCoord},"to":{"x_coord":to_xCoord,"y_coord":to_yCoord}};
 		} if (stringOrder.substring(0,10) == "removeGood") {
 			from_xCoord = stringOrder.substring(11,12);
 			from_yCoord = stringOrder.substring(13,14);
-			obj.push({"job":"remove","from":{"x_coord":from_xCoord,"y_coord":from_yCoord}});
+			order = {"job":"remove","from":{"x_coord":from_xCoord,"y_coord":from_yCoord}};
 		};
+		if (order == undefined) return;
+		// The moving robot, if there are several robots (/robot/move(1,1)/?robot=1).
+		if (order.job == "move" && req.query.robot != undefined) {
+			order.robot = parseInt(req.query.robot);
+		}
+		// Optional latest position of the order in the queue (/robot/move(1,1)/?deadline=0).
+		if (req.query.deadline != undefined) {
+			order.deadline = parseInt(req.query.deadline);
+		}
+
+		recordOrder(order);
+		readState(function (state) {
+			console.log('Order ' + stringOrder + ': ' + ingestOrder(obj, order, state));
+			fs.writeFile('./orders.js', JSON.stringify(obj, null,1), function (err) {
+				if (err) return console.log(err);
+				console.log('writing to ' + './orders.js');
+				preemptIdleJob();
+				// An urgent order (/robot/removeGood(1,1)/?urgent) does not
+				// wait for a long search of the running order.
+				if (req.query.urgent != undefined) preemptPlanning();
+			});
+		});
+	});
+});
 
-		fs.writeFile('./orders.js', JSON.stringify(obj, null,1), function (err) {
-			if (err) return console.log(err);
-			console.log('writing to ' + './orders.js');
+// Relocates several goods in one plan, e.g. a swap of two goods:
+// /relocate?moves=[{"from":{"x_coord":1,"y_coord":1},"to":{"x_coord":2,"y_coord":1}},...]
+// The planner uses free sections as buffers between the moves.
+app.get('/relocate', function (req, res) {
+	var moves;
+	try {
+		moves = JSON.parse(req.query.moves);
+	} catch (e) {
+		return res.status(400).send('moves must be a JSON array');
+	}
+	if (!Array.isArray(moves) || moves.length == 0) return res.status(400).send('moves must be a JSON array');
+
+	fs.readFile('./orders.js', 'utf8', function (err, data) {
+		if (err) throw err;
+		var obj = JSON.parse(data);
+		var order = {"job":"relocate","moves":moves};
+		if (req.query.deadline != undefined) {
+			order.deadline = parseInt(req.query.deadline);
+		}
+		res.send('Server recieved order: relocate ' + moves.length + ' goods');
+		recordOrder(order);
+		readState(function (state) {
+			console.log('Order relocate: ' + ingestOrder(obj, order, state));
+			fs.writeFile('./orders.js', JSON.stringify(obj, null,1), function (err) {
+				if (err) return console.log(err);
+				console.log('writing to ' + './orders.js');
+				preemptIdleJob();
+			});
 		});
 	});
 });
@@ -96,19 +454,289 @@ app.get('/add/:name/:temp_min/:temp_max/:light_min/:light_max', function (req, r
 				"desiredLighting":{"min":good.light_min, "max":good.light_max}
 			}
 		});
+		obj[obj.length-1].deadline = req.query.deadline != undefined
+			? parseInt(req.query.deadline) : obj.length - 1 + sequenceMaxDelay;
+		recordOrder(obj[obj.length-1]);
 
 		fs.writeFile('./orders.js', JSON.stringify(obj, null,1), function (err) {
 			if (err) return console.log(err);
 			console.log('writing to ' + './orders.js');
+			preemptIdleJob();
 		});
 	});
 });
 
 
+// Evaluates hypothetical orders against the current state, without
+// changing it: /whatif?orders=[{"job":"placeGood",...},[...a batch...]]
+// Answers with a table of the cost, the feasibility and the resulting
+// penalty of each order. Optional per-order budget in ms (&budget=200).
+app.get('/whatif', function (req, res) {
+	var orders;
+	try {
+		orders = JSON.parse(req.query.orders);
+	} catch (e) {
+		return res.status(400).send('orders must be a JSON array');
+	}
+	if (!Array.isArray(orders)) return res.status(400).send('orders must be a JSON array');
+
+	var job = {"job":"whatif","orders":withoutDeadlines(orders)};
+	if (req.query.budget != undefined) {
+		job.budget = parseInt(req.query.budget);
+	}
+	whatIf(job, function (line) {
+		if (line.length <= 7) return res.status(500).send('planner error');
+		res.json(JSON.parse(line.substring(7)));
+	});
+});
+
+// Queries the goods of the current state with the indexes of the planner:
+// /inventory?query=where&name=..  the goods with this name
+// /inventory?query=at&x_coord=..&y_coord=..  the good at this place
+// /inventory?query=free  the free Warehouse places (&garage=true for all)
+// /inventory?query=slots&tempMin=..&tempMax=..&lightMin=..&lightMax=..
+//   the free Warehouse places that fit these ranges
+// /inventory?query=misplaced  the goods out of their range
+// Without a query, it answers the number of goods and of free places.
+app.get('/inventory', function (req, res) {
+	var job = {"job":"inventory"};
+	['query', 'name', 'x_coord', 'y_coord', 'tempMin', 'tempMax', 'lightMin', 'lightMax'].forEach(function (key) {
+		if (req.query[key] != undefined) job[key] = req.query[key];
+	});
+	if (req.query.garage != undefined) job.garage = req.query.garage == 'true';
+	plan(job, function (line) {
+		if (line.substring(0,10) != 'INVENTORY:') return res.status(500).send('planner error');
+		res.json(JSON.parse(line.substring(10)));
+	});
+});
+
+// A single sensor reading: /sensor?id=1&temperature=21&lighting=110
+app.get('/sensor', function (req, res) {
+	if (req.query.id == undefined || req.query.temperature == undefined || req.query.lighting == undefined) {
+		return res.status(400).send('id, temperature and lighting are needed');
+	}
+	sendReading(req.query);
+	res.send('Server recieved reading');
+});
+
+// The recent alerts of the sensor readings.
+app.get('/alerts', function (req, res) {
+	res.json(alerts);
+});
+
+// Withdraws the order that is planned at the moment. The robot gets empty
+// instructions for it.
+app.get('/cancel', function (req, res) {
+	res.send('Server recieved cancel');
+	if (gecodeRunning && planner != null) {
+		planner.stdin.write('{"job":"cancel"}\n');
+		console.log('Planning of the running order cancelled.');
+	}
+});
+
+// A real order has always a higher priority than an idle job. If the
+// planner is still working on an idle job, the new order is sent
+// immediately and the planner stops the idle job and drops its plan, when
+// it receives it.
+function preemptIdleJob(){
+	if (idleRunning) {
+		idleRunning = false;
+		gecodeRunning = false;
+		console.log('Idle job preempted by a new order.');
+		sendOrderToGecode();
+	}
+};
+
+// Stops the search of the running order. The planner keeps the best plan
+// found so far for it, and the next order is sent right after it.
+function preemptPlanning(){
+	if (gecodeRunning && !idleRunning && planner != null) {
+		urgentPending = true;
+		planner.stdin.write('{"job":"preempt"}\n');
+		console.log('Planning of the running order preempted by an urgent order.');
+	}
+};
+
+// Takes the next orders from the queue that can be planned together in one
+// run of the planner. A batch contains at most one add and one remove order
+// (they use the fixed add and drop zone), a move order must be the last one
+// and no order may take a good from or bring a good to a section that an
+// earlier order of the batch has used. Otherwise the batch could have no
+// joint plan, and the orders that were feasible alone would be lost.
+// A relocate order is planned alone, it has its own pick up and drop pairs.
+// A single order is sent as it is, a batch as an array.
+function takeBatch(obj){
+	var batch = [];
+	var adds = 0;
+	var removes = 0;
+	var used = [];
+	while (obj[0] != undefined && batch.length < batchSize) {
+		var order = obj[0];
+		if (order.job == "relocate" && batch.length > 0) break;
+		if (order.job == "add" && adds > 0) break;
+		if (order.job == "remove" && removes > 0) break;
+		if (order.from != undefined && used.indexOf(positionKey(order.from)) >= 0) break;
+		// The target of a move is only the place of the robot.
+		if (order.job != "move" && order.to != undefined && used.indexOf(positionKey(order.to)) >= 0) break;
+
+		batch.push(obj.shift());
+		if (order.job == "add") adds++;
+		if (order.job == "remove") removes++;
+		if (order.from != undefined) used.push(positionKey(order.from));
+		if (order.to != undefined) used.push(positionKey(order.to));
+		if (order.job == "move" || order.job == "relocate") break;
+	}
+	if (batch.length == 1) return batch[0];
+	return batch;
+};
+
+// The resident planner plans one job per line and answers with one line.
+// It keeps its state between the orders, and it plans the next order in the
+// background, while the robot executes the current one.
+var planner = null;
+var plannerCallbacks = [];
+var stateCallbacks = [];
+var whatIfCallbacks = [];
+var plannerOutput = '';
+
+function startPlanner(){
+	var spawn = require('child_process').spawn;
+	planner = spawn('./warehouse', ['-resident', '-encoding', instructionEncoding]);
+	planner.stdout.on('data', function (data) {
+		plannerOutput += data.toString();
+		var lines = plannerOutput.split('\n');
+		plannerOutput = lines.pop();
+		lines.forEach(function (line) {
+			// The inbound dock of an added good comes before the answer.
+			if (line.substring(0,5) == "DOCK:") {
+				var dock = JSON.parse(line.substring(5));
+				console.log('Put the new good at the inbound dock (' + dock.x_coord + ',' + dock.y_coord + ')');
+				return;
+			}
+			// A sensor reading has no answer, only an alert, when a good
+			// leaves or reenters its range.
+			if (line.substring(0,6) == "ALERT:") {
+				logAlert(JSON.parse(line.substring(6)));
+				return;
+			}
+			// The state queries are answered out of the order of the jobs.
+			if (line.substring(0,6) == "STATE:") {
+				var callback = stateCallbacks.shift();
+				if (callback != undefined) {
+					callback(line.length > 6 ? JSON.parse(line.substring(6)) : emptyState());
+				}
+				return;
+			}
+			// The what-if jobs are planned by their own thread, they do
+			// not wait for the running order.
+			if (line.substring(0,7) == "WHATIF:") {
+				var callback = whatIfCallbacks.shift();
+				if (callback != undefined) callback(line);
+				return;
+			}
+			var callback = plannerCallbacks.shift();
+			if (callback != undefined) callback(line);
+		});
+	});
+	planner.on('exit', function () {
+		console.log('Planner stopped, it is started again with the next job.');
+		planner = null;
+		plannerOutput = '';
+		plannerCallbacks.splice(0).forEach(function (callback) {
+			callback('INSTRUCTIONS:');
+		});
+		stateCallbacks.splice(0).forEach(function (callback) {
+			callback(emptyState());
+		});
+		whatIfCallbacks.splice(0).forEach(function (callback) {
+			callback('WHATIF:');
+		});
+	});
+};
+
+function plan(job, callback){
+	if (planner == null) startPlanner();
+	plannerCallbacks.push(callback);
+	planner.stdin.write(JSON.stringify(job) + '\n');
+};
+
+function whatIf(job, callback){
+	if (planner == null) startPlanner();
+	whatIfCallbacks.push(callback);
+	planner.stdin.write(JSON.stringify(job) + '\n');
+};
+
+// The sensors send their readings as JSON lines ({"id":1,"temperature":21,
+// "lighting":110}) to the sensor port or to /sensor. The planner keeps the
+// rolling means of the readings as the values of the sensors.
+var sensorPort = 3001;
+// Number of recent alerts, that are kept for /alerts.
+var alertsSize = 50;
+var alerts = [];
+
+function sendReading(reading){
+	if (planner == null) startPlanner();
+	planner.stdin.write(JSON.stringify({"job":"sensor","id":parseInt(reading.id),
+		"temperature":parseInt(reading.temperature),"lighting":parseInt(reading.lighting)}) + '\n');
+};
+
+function logAlert(alert){
+	alert.goods.forEach(function (good) {
+		console.log('Sensor ' + alert.sensor + ': ' + good.name + ' at (' + good.x_coord + ',' + good.y_coord + ') is '
+			+ (good.inRange ? 'in its range again' : 'out of its range') + ' (' + alert.temperature.mean + ' degrees, ' + alert.lighting.mean + ' lux)');
+	});
+	alert.time = Date.now();
+	alerts.push(alert);
+	if (alerts.length > alertsSize) alerts.shift();
+};
+
+require('net').createServer(function (socket) {
+	var received = '';
+	socket.on('data', function (data) {
+		received += data.toString();
+		var lines = received.split('\n');
+		received = lines.pop();
+		lines.forEach(function (line) {
+			try {
+				sendReading(JSON.parse(line));
+			} catch (e) {
+				console.log('Invalid sensor reading: ' + line);
+			}
+		});
+	});
+}).listen(sensorPort, function () {
+	console.log('Sensor readings on port ' + sensorPort);
+});
+
+// The deadlines are only used by the sequencer. They are removed from the
+// orders for the planner, since they change with the queue and the planner
+// compares the next order with its speculative plan.
+function withoutDeadlines(batch){
+	return JSON.parse(JSON.stringify(batch, function (key, value) {
+		return key == 'deadline' ? undefined : value;
+	}));
+};
+
+// Reorders the first orders of the queue with the sequencer of the planner,
+// so that the robot travels as little as possible between the orders. The
+// queue is read again afterwards, since new orders may have been appended
+// in the meantime.
+function sequenceOrders(obj, callback){
+	var window = obj.slice(0, sequenceWindow);
+	if (window.length < 2) return callback(obj);
+
+	plan({"job":"sequence","orders":window}, function (line) {
+		if (line.substring(0,7) != 'ORDERS:') return callback(obj);
+		fs.readFile('./orders.js', 'utf8', function (err, data) {
+			if (err) return callback(obj);
+			var queue = JSON.parse(data);
+			callback(JSON.parse(line.substring(7)).concat(queue.slice(window.length)));
+		});
+	});
+};
+
 function sendOrderToGecode(){
 	var stdin = process.openStdin();
-	var exec = require('child_process').exec;
-	var cmd;
 
 
 	var fs = require('fs');
@@ -127,37 +755,65 @@ function sendOrderToGecode(){
 			fs.writeFile('./orders.js', JSON.stringify(obj, null,1), function (err) {
 				if (err) return console.log(err);
 				gecodeRunning = true;
-				console.log('No orders ready in /orders.js');
-				cmd  = 'echo \'null\' | ./warehouse';
-				exec(cmd, function(error, stdout, stderr) {
-
+				idleRunning = true;
+				console.log('No orders ready in /orders.js, sending idle job');
+				// Without a misplaced good, the planner moves the robot
+				// towards the recent orders.
+				plan({"job":"idle","history":orderHistory}, function(stdout) {
+					var preempted = !idleRunning;
+					if (idleRunning) {
+						idleRunning = false;
+						gecodeRunning = false;
+					}
 					console.log(stdout);
-					gecodeRunning = false;
-					btSerial.write(new Buffer('  '+stdout, 'utf-8'), function(err, bytesWritten) {
-						console.log(bytesWritten)
-						if (err) console.log(err);
-					});
+					// The planner drops the plan of a preempted idle job, the
+					// robot waits for the new order. Only an idle plan, that
+					// was finished before the order came, is executed.
+					if (preempted && stdout == 'INSTRUCTIONS:') return;
+					sendToRobots(stdout);
 				});
 			});
 		} else{
 			gecodeRunning = true;
-            orderToSend = obj.shift();
-            cmd  = 'echo \'' + JSON.stringify(orderToSend) +'\' | ./warehouse';
-            exec(cmd, function(error, stdout, stderr) {
-                //callback
-                gecodeRunning = false;
-				console.log(stdout);
-                btSerial.write(new Buffer('  '+stdout, 'utf-8'), function(err, bytesWritten) {
-                    console.log(bytesWritten)
-                    if (err) console.log(err);
-                });
-
-
-            });
-            fs.writeFile('./orders.js', JSON.stringify(obj, null,1), function (err) {
-                if (err) return console.log(err);
-                console.log('Popped order from: /orders.js');
-            });
+			// Orders, that were queued without a deadline (e.g. before an
+			// update), get the bound of their current position once.
+			obj.forEach(function (order, k) {
+				if (order.deadline == undefined) order.deadline = k + sequenceMaxDelay;
+			});
+			sequenceOrders(obj, function (obj) {
+				var queued = obj.length;
+				orderToSend = takeBatch(obj);
+
+				// The deadlines are positions in the queue, so they move
+				// forward with the queue.
+				obj.forEach(function (order) {
+					if (order.deadline != undefined) {
+						order.deadline = Math.max(0, order.deadline - (queued - obj.length));
+					}
+				});
+
+				// The next batch is planned speculatively, while the robot
+				// executes this one.
+				var job = {"job":"plan","order":withoutDeadlines(orderToSend)};
+				if (obj.length > 0) {
+					job.next = withoutDeadlines(takeBatch(obj.slice()));
+				}
+				plan(job, function(stdout) {
+					//callback
+					gecodeRunning = false;
+					console.log(stdout);
+					sendToRobots(stdout);
+
+					if (urgentPending) {
+						urgentPending = false;
+						sendOrderToGecode();
+					}
+				});
+				fs.writeFile('./orders.js', JSON.stringify(obj, null,1), function (err) {
+					if (err) return console.log(err);
+					console.log('Popped order from: /orders.js');
+				});
+			});
 		};
 
 
@@ -0,0 +1,81 @@
+// Fits the durations of the robot instructions for the planner from the
+// executions logged in ./timings.log and writes them to ./calibration.js.
+// The planner minimizes the estimated execution time with them.
+//
+//   node calibrate.js [timings.log] [calibration.js]
+//
+// Turns, backward steps, picks and drops take the median of their
+// durations (a stalled robot should not shift the estimate). A forward
+// movement is fitted as base + perCell * cells by least squares.
+var fs = require('fs');
+var timingsFile = process.argv[2] || './timings.log';
+var calibrationFile = process.argv[3] || './calibration.js';
+
+function median(values){
+	if (values.length == 0) return undefined;
+	var sorted = values.slice().sort(function (a, b) { return a - b; });
+	var middle = Math.floor(sorted.length / 2);
+	if (sorted.length % 2 == 1) return sorted[middle];
+	return (sorted[middle - 1] + sorted[middle]) / 2;
+};
+
+// Least squares fit of ms = base + perCell * cells. With only one distance,
+// the forward movement is proportional to the distance.
+function fitForward(samples){
+	if (samples.length == 0) return undefined;
+	var n = samples.length;
+	var sx = 0, sy = 0, sxx = 0, sxy = 0;
+	samples.forEach(function (s) {
+		sx += s.cells;
+		sy += s.ms;
+		sxx += s.cells * s.cells;
+		sxy += s.cells * s.ms;
+	});
+	var denominator = n * sxx - sx * sx;
+	if (denominator == 0) {
+		return {"base": 0, "perCell": Math.round(sy / sx)};
+	}
+	var perCell = (n * sxy - sx * sy) / denominator;
+	var base = (sy - perCell * sx) / n;
+	// A negative base or slope is noise of too few samples.
+	if (base < 0 || perCell < 0) {
+		return {"base": 0, "perCell": Math.round(sy / sx)};
+	}
+	return {"base": Math.round(base), "perCell": Math.round(perCell)};
+};
+
+var samples = {"TURN": [], "BACKWARD": [], "PICK": [], "DROP": []};
+var forward = [];
+fs.readFileSync(timingsFile, 'utf8').split('\n').forEach(function (line) {
+	if (line.trim() == '') return;
+	var entry = JSON.parse(line);
+	if (entry.instruction == "FORWARD" && entry.value > 0) {
+		forward.push({"cells": entry.value, "ms": entry.ms});
+	} else if (samples[entry.instruction] != undefined) {
+		samples[entry.instruction].push(entry.ms);
+	}
+});
+
+// Values without samples are kept from the current calibration.
+var calibration = {"unit": 100};
+try {
+	calibration = JSON.parse(fs.readFileSync(calibrationFile, 'utf8'));
+} catch (err) {}
+
+var names = {"TURN": "turn", "BACKWARD": "backward", "PICK": "pick", "DROP": "drop"};
+Object.keys(names).forEach(function (instruction) {
+	var value = median(samples[instruction]);
+	if (value != undefined) calibration[names[instruction]] = Math.round(value);
+	console.log(instruction + ': ' + samples[instruction].length + ' samples, ' + calibration[names[instruction]] + ' ms');
+});
+var fit = fitForward(forward);
+if (fit != undefined) calibration.forward = fit;
+console.log('FORWARD: ' + forward.length + ' samples, ' + JSON.stringify(calibration.forward));
+
+// A misplaced good costs as much as 100 turns, if no penalty is given.
+if (calibration.penalty == undefined && calibration.turn != undefined) {
+	calibration.penalty = 100 * calibration.turn;
+}
+
+fs.writeFileSync(calibrationFile, JSON.stringify(calibration, null, 1));
+console.log('writing to ' + calibrationFile + ', restart the planner to use it');
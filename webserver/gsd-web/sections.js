@@ -1,5 +1,6 @@
 [
    {
+      "dock" : "inbound",
       "good" : false,
       "sensor" : false,
       "status" : "free",
@@ -28,6 +29,7 @@
       "y_coord" : 1
    },
    {
+      "dock" : "outbound",
       "good" : false,
       "sensor" : false,
       "status" : "free",